@@ -0,0 +1,339 @@
+/***
+*raid6_bench.cpp - throughput benchmark for the raid6 library
+*
+*       Copyright (c) Bingle	All rights reserved.
+*
+*Purpose:
+*       Non-interactive recover benchmark for perf tracking. Each case is warmed
+*       up, then timed run by run with a steady clock.
+*       usage: raid6_bench [-n numDisk] [-s KBPerDisk] [-c categories] [-t threads]
+*                          [-k kernels] [-f families] [-T tileKB] [-P prefetch] [-p prime] [-r runs] [-w warmups] [-N] [-j]
+*       lists are comma separated, -j prints json instead of the table. -N runs
+*       on the cpus of numa node 0 with the buffers on node 0 and on the last
+*       node, local against remote, and remote again with the workers following
+*       the memory.
+*
+*Author:
+*		Bingle(BinaryBB@hotmail.com)
+****/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include "../raid6_lib/raid6.hpp"
+#include "../raid6_lib/raid6_numa.hpp"
+#if defined(LIB_VC10_OPTIMIZE_ENABLED)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+using namespace raid6;
+
+enum {
+	eAlign			= 64,
+	eDefRuns		= 50,		//timed runs of each case
+	eDefWarmups		= 3,
+	eMaxList		= 16,
+};
+
+//failure categories, same as raid6_test's report
+struct SCategory {
+	const char*	name;
+	int			miss1;
+	int			miss2;
+};
+static const SCategory gCategory[] = {
+	{"d",	eDiaIdx, eDiaIdx},		//diagonal parity
+	{"r",	eRowIdx, eRowIdx},		//row parity
+	{"x",	2, 2},					//one data
+	{"dr",	eDiaIdx, eRowIdx},		//both parities
+	{"dx",	eDiaIdx, 2},			//diagonal and data
+	{"rx",	eRowIdx, 2},			//row and data
+	{"xx",	2, 3},					//two data
+};
+enum { eCategoryNum = sizeof(gCategory)/sizeof(gCategory[0]) };
+static const char* gKernelName[eKernelNum] = {"scalar", "sse2", "avx2", "avx512"};
+static const char* gFamilyName[eFamilyNum] = {"unroll", "loop"};
+static const char* gPrefetchName[ePrefetchNum] = {"off", "auto", "on"};
+
+//where the buffers are and where the work runs
+enum {
+	ePlaceAny,					//malloc, no pinning
+	ePlaceLocal,				//node 0 buffers, node 0 cpus
+	ePlaceRemote,				//last node buffers, node 0 cpus
+	ePlaceFollow,				//last node buffers, workers on the node of the memory
+	ePlaceNum
+};
+static const char* gPlaceName[ePlaceNum] = {"any", "local", "remote", "follow"};
+
+struct SResult {
+	double	gbps;				//all disks' bytes per second / 1e9
+	double	p50Us;				//latency of one run
+	double	p99Us;
+	double	cyclesPerByte;		//time stamp counter ticks per byte of all disks, 0 if no counter
+};
+
+static unsigned long long read_tsc() {
+#if defined(LIB_VC10_OPTIMIZE_ENABLED) || defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+static void run_case(CRaid6& r6, T** block, size_t numBytes, int numDisk, const SCategory& c,
+	int runs, int warmups, SResult& res) {
+	typedef std::chrono::steady_clock steady_t;
+	for(int i=0; i<warmups; ++i) {
+		r6.recover(block, numBytes, numDisk, c.miss1, c.miss2);
+	}
+	std::vector<double> lat(runs);
+	double total = 0;
+	unsigned long long tsc0 = read_tsc();
+	for(int i=0; i<runs; ++i) {
+		steady_t::time_point t0 = steady_t::now();
+		r6.recover(block, numBytes, numDisk, c.miss1, c.miss2);
+		lat[i] = std::chrono::duration<double>(steady_t::now() - t0).count();
+		total += lat[i];
+	}
+	unsigned long long ticks = read_tsc() - tsc0;
+	double bytes = (double)numBytes*numDisk*runs;
+	std::sort(lat.begin(), lat.end());
+	res.gbps  = total>0? bytes/total/1e9 : 0;
+	res.p50Us = lat[ (runs-1)/2 ]*1e6;
+	res.p99Us = lat[ (size_t)( (runs-1)*0.99 + 0.5 ) ]*1e6;
+	res.cyclesPerByte = ticks/bytes;
+}
+
+//comma separated list of numbers or names, -1 if an item is not one of the names
+static int parse_list(const char* s, int* out, const char* const* names, int numName) {
+	int n = 0;
+	while(*s && n<eMaxList) {
+		const char* e = strchr(s, ',');
+		size_t len = e? (size_t)(e-s) : strlen(s);
+		int v = -1;
+		if(names) {
+			for(int i=0; i<numName; ++i) {
+				if( strlen(names[i])==len && 0==strncmp(names[i], s, len) ) v = i;
+			}
+		}
+		else {
+			v = atoi(s);
+		}
+		out[n++] = v;
+		s += len;
+		if(*s) ++s;
+	}
+	return n;
+}
+
+static int usage() {
+	printf("usage: raid6_bench [-n numDisk] [-s KBPerDisk] [-c categories] [-t threads] [-k kernels]\n"
+		"                   [-f families] [-T tileKB] [-P prefetch] [-p prime] [-r runs] [-w warmups] [-N] [-j]\n"
+		"  -n  disks in the array, default %d\n"
+		"  -s  KB of each disk per run, default 16384\n"
+		"  -c  failure categories d,r,x,dr,dx,rx,xx, default all\n"
+		"  -t  worker threads, default 1\n"
+		"  -k  kernels scalar,sse2,avx2,avx512, default the best one\n"
+		"  -f  kernel families unroll,loop, default the engine's\n"
+		"  -T  KB of all disks per cache tile, 0 not tiled, default the engine's\n"
+		"  -P  prefetch and streaming stores off,auto,on, default the engine's\n"
+		"  -p  prime, 5 17 or 257, default %d\n"
+		"  -r  timed runs of each case, default %d\n"
+		"  -w  warm up runs of each case, default %d\n"
+		"  -N  numa placement: local and remote buffers, remote followed by the workers\n"
+		"  -j  json output\n", (int)eImpDiskNum, (int)P, (int)eDefRuns, (int)eDefWarmups);
+	return errFAIL;
+}
+
+int main(int argc, char* argv[]) {
+	int numDisk = eImpDiskNum, kbPerDisk = 16*1024, prime = P;
+	int runs = eDefRuns, warmups = eDefWarmups, json = 0, numa = 0;
+	int category[eMaxList], numCategory = 0;
+	int thread[eMaxList] = {1}, numThread = 1;
+	int kernel[eMaxList], numKernel = 0;
+	int family[eMaxList], numFamily = 0;
+	int tile[eMaxList], numTile = 0;
+	int prefetch[eMaxList], numPrefetch = 0;
+	const char* categoryName[eCategoryNum];
+	for(int i=0; i<eCategoryNum; ++i) {
+		categoryName[i] = gCategory[i].name;
+	}
+
+	for(int i=1; i<argc; ++i) {
+		if('-'!=argv[i][0]) return usage();
+		if('j'==argv[i][1]) {
+			json = 1;
+			continue;
+		}
+		if('N'==argv[i][1]) {
+			numa = 1;
+			continue;
+		}
+		if(i+1>=argc) return usage();
+		const char* v = argv[++i];
+		switch(argv[i-1][1]) {
+		case 'n': numDisk   = atoi(v); break;
+		case 's': kbPerDisk = atoi(v); break;
+		case 'p': prime     = atoi(v); break;
+		case 'r': runs      = atoi(v); break;
+		case 'w': warmups   = atoi(v); break;
+		case 'c': numCategory = parse_list(v, category, categoryName, eCategoryNum); break;
+		case 't': numThread   = parse_list(v, thread, 0, 0); break;
+		case 'k': numKernel   = parse_list(v, kernel, gKernelName, eKernelNum); break;
+		case 'f': numFamily   = parse_list(v, family, gFamilyName, eFamilyNum); break;
+		case 'T': numTile     = parse_list(v, tile, 0, 0); break;
+		case 'P': numPrefetch = parse_list(v, prefetch, gPrefetchName, ePrefetchNum); break;
+		default:  return usage();
+		}
+	}
+
+	CRaid6 r6;
+	if(0==numCategory) {
+		for(; numCategory<eCategoryNum; ++numCategory) category[numCategory] = numCategory;
+	}
+	if(0==numKernel) {
+		kernel[numKernel++] = r6.get_kernel();
+	}
+	if(0==numFamily) {
+		family[numFamily++] = r6.get_family();
+	}
+	if(0==numTile) {
+		tile[numTile++] = (int)( r6.get_tile_bytes()/1024 );
+	}
+	if(0==numPrefetch) {
+		prefetch[numPrefetch++] = r6.get_prefetch();
+	}
+	if( errOK!=r6.set_prime(prime) || numDisk<4 || numDisk>r6.get_max_disk_num() || kbPerDisk<=0 || runs<=0 || warmups<0 ) {
+		return usage();
+	}
+	for(int i=0; i<numCategory; ++i) {
+		if(category[i]<0) return usage();
+	}
+	for(int i=0; i<numThread; ++i) {
+		if(thread[i]<1) return usage();
+	}
+	for(int i=0; i<numTile; ++i) {
+		if(tile[i]<0) return usage();
+	}
+	for(int i=0; i<numFamily; ++i) {
+		if(family[i]<0) return usage();
+	}
+	for(int i=0; i<numPrefetch; ++i) {
+		if(prefetch[i]<0) return usage();
+	}
+	for(int i=0; i<numKernel; ++i) {
+		if( !r6.is_kernel_supported(kernel[i]) ) {
+			printf("kernel %s not supported\n", kernel[i]<0? "?" : gKernelName[kernel[i]]);
+			return errKernelNotSupported;
+		}
+	}
+
+	//pinned before any worker is made, the workers start on node 0 cpus too
+	int place[ePlaceNum], numPlace = 0;
+	int numNode = CRaid6Numa::get_node_num();
+	if(numa) {
+		CRaid6Numa::bind_thread(0);
+		place[numPlace++] = ePlaceLocal;
+		if(numNode>1) {
+			place[numPlace++] = ePlaceRemote;
+			place[numPlace++] = ePlaceFollow;
+		}
+	}
+	else {
+		place[numPlace++] = ePlaceAny;
+	}
+
+	size_t numBytes = (size_t)kbPerDisk*1024;
+	numBytes -= numBytes % r6.get_align_bytes();
+	if(0==numBytes) numBytes = r6.get_align_bytes();
+	//[0] the malloc or node 0 buffers, [1] the last node ones
+	T* block[2][eLimitDiskNum+1];
+	char* raw[eLimitDiskNum+1];
+	for(int s=0; s<2; ++s) {
+		if(s>0 && numPlace<2) break;
+		for(int i=0; i<numDisk; ++i) {
+			if(numa) {
+				block[s][i] = (T*)CRaid6Numa::alloc(numBytes, s? numNode-1 : 0);
+			}
+			else {
+				raw[i] = (char*)malloc(numBytes + eAlign);
+				block[s][i] = raw[i]? get_aligned_ptr<T, char, eAlign>(raw[i]) : 0;
+			}
+			if(!block[s][i]) {
+				printf("out of memory\n");
+				return errFAIL;
+			}
+			for(size_t j=0; j<numBytes/sizeof(T); ++j) {
+				block[s][i][j] = ( (T)rand()<<32 ) ^ rand();
+			}
+		}
+	}
+
+	if(json) {
+		printf("{\"prime\":%d,\"disks\":%d,\"bytesPerDisk\":%llu,\"runs\":%d,\"warmups\":%d,\"results\":[",
+			prime, numDisk, (unsigned long long)numBytes, runs, warmups);
+	}
+	else {
+		printf("disks=%d, %llu bytes per disk, prime=%d, %d runs, GB/s counts all disks' bytes\n",
+			numDisk, (unsigned long long)numBytes, prime, runs);
+		if(numa) {
+			int node[2] = {-1, -1};
+			const void* addr[2] = {block[0][0], block[numPlace>1][0]};
+			CRaid6Numa::get_mem_node(addr, 2, node);
+			printf("numa nodes=%d, cpus of node 0, local buffers on node %d, remote on node %d%s\n", numNode, node[0], node[1],
+				numNode>1? "" : ", one node so no remote runs");
+		}
+		printf("%-4s %-8s %-6s %-5s %8s %8s %-6s %10s %12s %12s %8s\n", "case", "kernel", "family", "pf", "threads", "tileKB", "place", "GB/s", "p50(us)", "p99(us)", "cyc/B");
+	}
+	int first = 1;
+	for(int k=0; k<numKernel*numFamily*numPrefetch; ++k) {
+		int kern = kernel[k/numPrefetch/numFamily], fam = family[k/numPrefetch%numFamily], pf = prefetch[k%numPrefetch];
+		r6.set_kernel(kern);
+		r6.set_family(fam);
+		r6.set_prefetch(pf);
+		for(int t=0; t<numThread; ++t) {
+			r6.set_thread_num(thread[t]);
+			for(int c=0; c<numCategory*numTile*numPlace; ++c) {
+				int where = place[c%numPlace];
+				//one thread runs on the caller, following the memory is the remote run again
+				if(ePlaceFollow==where && thread[t]<2) continue;
+				r6.set_numa(ePlaceFollow==where);
+				r6.set_tile_bytes( (size_t)tile[c/numPlace%numTile]*1024 );
+				const SCategory& cat = gCategory[ category[c/numPlace/numTile] ];
+				SResult res;
+				run_case(r6, block[where>=ePlaceRemote], numBytes, numDisk, cat, runs, warmups, res);
+				if(json) {
+					printf("%s\n{\"category\":\"%s\",\"miss\":[%d,%d],\"kernel\":\"%s\",\"family\":\"%s\",\"prefetch\":\"%s\",\"threads\":%d,\"tile_kb\":%d,\"place\":\"%s\","
+						"\"gbps\":%.3f,\"p50_us\":%.2f,\"p99_us\":%.2f,\"cycles_per_byte\":%.4f}",
+						first? "" : ",", cat.name, cat.miss1, cat.miss2, gKernelName[kern], gFamilyName[fam], gPrefetchName[pf], thread[t], tile[c/numPlace%numTile],
+						gPlaceName[where], res.gbps, res.p50Us, res.p99Us, res.cyclesPerByte);
+				}
+				else {
+					printf("%-4s %-8s %-6s %-5s %8d %8d %-6s %10.2f %12.2f %12.2f %8.3f\n", cat.name, gKernelName[kern], gFamilyName[fam], gPrefetchName[pf], thread[t], 
+						tile[c/numPlace%numTile], gPlaceName[where], res.gbps, res.p50Us, res.p99Us, res.cyclesPerByte);
+				}
+				first = 0;
+			}
+			r6.set_numa(0);
+		}
+	}
+	if(json) {
+		printf("\n]}\n");
+	}
+
+	for(int s=0; s<2; ++s) {
+		if(s>0 && numPlace<2) break;
+		for(int i=0; i<numDisk; ++i) {
+			if(numa) CRaid6Numa::release(block[s][i], numBytes);
+			else     free(raw[i]);
+		}
+	}
+	return errOK;
+}
@@ -13,468 +13,515 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
-#include "raid6.hpp"
-
-namespace raid6{
-
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include "raid6_engine.hpp"
+#include "raid6_pool.hpp"
+#include "raid6_numa.hpp"
 #ifdef LIB_VC10_OPTIMIZE_ENABLED
-#define INLINE_FN_GEN1( ret_t ) public: static __forceinline ret_t gen(block_t b)
-#define INLINE_FN_GEN2( ret_t ) public: static __forceinline ret_t gen(block_t b, T& s) 
-#else
-#ifdef LIB_GCC4_1_OPTIMIZE_ENABLED 
-#define INLINE_FN_GEN1( ret_t ) public: static inline ret_t gen(block_t b) __attribute__((always_inline))
-#define INLINE_FN_GEN2( ret_t ) public: static inline ret_t gen(block_t b, T& s) __attribute__((always_inline))
-#else // no optimize enabled
-#define INLINE_FN_GEN1( ret_t ) public: static ret_t gen(block_t b)
-#define INLINE_FN_GEN2( ret_t ) public: static ret_t gen(block_t b, T& s) 
+#include <intrin.h>
 #endif
+#ifdef LIB_GCC4_1_OPTIMIZE_ENABLED
+#include <unistd.h>
 #endif
 
-//*****************************************************************************    
-//class CGenericRaid6: the generic raid6 class. 
-//Purpose:
-//  Target to generate raid6 operating code with generic programming technique
-//Template arguements naming :
-//  T:      the base data type.( ALIGN_TYPE, __int64 in this target implement)
-//  P:      the Prime, 2^n+1
-//  _ND:    total disk number, include parity disks and data disks
-//  _IX:    X direction index, start from 0
-//  _IY:    Y direction index, start from 0
-//  _CX:    X direction count, start from 1
-//  _CY:    Y direction count, start from 1
-//  _Of:    Offset value
-//  _Ms:    missing disk index,(0 ~ _ND-1).
-//  _M1,_M2 first,second missing disk index,assert(_M1 <= _M2)!
-//Comment:
-//  assert diagonal index is 0, row parity index is 1,data disk index start form 2 to _ND-1.
-//*****************************************************************************
-template <int _ND>
-class CGenericRaid6{
-private: //core expressions
-	//expression template for row indexer
-	template<int _Of, int _CX, int _IY>
-	class et_row_indexer {
-		INLINE_FN_GEN1( T ) {
-			return  b[_Of][_IY] ^ et_row_indexer<_Of+1, _CX-1, _IY>::gen(b) ;
-		}
-	};
-	template<int _Of,  int _IY>
-	class et_row_indexer<_Of, 1, _IY> {
-		INLINE_FN_GEN1( T ) {
-			return b[_Of][_IY];
-		}
-	};
-	template<int _Of,  int _IY>
-	class et_row_indexer<_Of, 0, _IY> {
-		INLINE_FN_GEN1( T ) {
-			return 0;
-		}
-	};
-	//expression template for diagonal indexer
-	template<int _Of, int _CX, int _IY>
-	class et_diagonal_indexer {
-		INLINE_FN_GEN1( T ) {
-			return b[_Of][_IY] ^ et_diagonal_indexer<_Of+1, _CX-1, _IY-1>::gen(b);
-		}
-	};
-	template<int _Of,  int _IY>
-	class et_diagonal_indexer<_Of, 1, _IY> {
-		INLINE_FN_GEN1( T ) {
-			return b[_Of][_IY];
-		}
-	};
-	template<int _Of, int _CX>
-	class et_diagonal_indexer<_Of, _CX, -1> {
-		INLINE_FN_GEN1( T ) {
-			return et_diagonal_indexer<_Of+1, _CX-1, P-2>::gen(b);
-		}
-	};
-	template<int _Of >
-	class et_diagonal_indexer<_Of, 1, -1> {
-		INLINE_FN_GEN1( T ) {
-			return 0;
-		}
-	};
-	template<int _Of,  int _IY>
-	class et_diagonal_indexer<_Of, 0, _IY> {
-		INLINE_FN_GEN1( T ) {
-			return 0;
-		}
-	};
-	template<int _Of >
-	class et_diagonal_indexer<_Of, 0, -1> {
-		INLINE_FN_GEN1( T ) {
-			return 0;
-		}
-	};
-	//expression template for increase pointer by (P-1). 
-	template <int _IX, int _Of, int _CX> 
-	class et_add_ptr {
-		INLINE_FN_GEN1( void ) {
-			b[_Of] += (P-1); et_add_ptr<_IX, _Of+1, _CX-1>::gen(b);
-		}
-	};
-	template <int _IX, int _Of> 
-	class et_add_ptr<_IX, _Of, 1> {
-		INLINE_FN_GEN1( void ) {
-			b[_IX] += (P-1); b[_Of] += (P-1);
-		}
-	};
-	//expression template for cal syndrome when missing two data
-	template<int _IY, int _IX1, int _IX2>
-	class et_syndrome{
-		INLINE_FN_GEN1( T ) {
-			//return b[eDiaIdx][_IY] ^ et_syndrome< _IY-1>::gen(b) ^ b[eRowIdx][_IY] ;
-			return et_syndrome<_IY-1, _IX1, _IX2>::gen(b) ^ b[_IX1][_IY] ^ b[_IX2][_IY] ;
-		}
-	};
-	template<int _IX1, int _IX2>
-	class et_syndrome<0, _IX1, _IX2>{
-		INLINE_FN_GEN1( T ) {
-			return b[_IX1][0] ^ b[_IX2][0] ;
-		}
-	}; //end core expressions
-	//expression template for row parity block
-	template<int _CX, int _IY>
-	class et_row_block {
-		INLINE_FN_GEN1( void ) {
-			et_row_block<_CX, _IY-1>::gen(b);
-			b[eRowIdx][_IY] = et_row_indexer<2, _CX, _IY>::gen(b) ;
-		}
-	};
-	template <int _CX>
-	class et_row_block<_CX, 0> {
-		INLINE_FN_GEN1( void ) {
-			b[eRowIdx][0] = et_row_indexer<2, _CX, 0>::gen(b) ;
-		}
-	};
-	//expression template for recover x from row line
-	template<int _IY, int _Ms>
-	class et_x_from_row{
-		INLINE_FN_GEN1( void ) {
-			b[_Ms][_IY] = et_row_indexer<eRowIdx, _Ms-eRowIdx, _IY>::gen(b)
-				^ et_row_indexer<_Ms+1, _ND-_Ms-1, _IY>::gen(b);
-		}
-	};
-	//expression template for recover x from row block
-	template<int _IY, int _Ms>
-	class et_x_from_row_block{
-		INLINE_FN_GEN1( void ) {
-			et_x_from_row_block<_IY-1, _Ms>::gen(b);
-			et_x_from_row<_IY, _Ms>::gen(b);
-		}
-	};
-	template<  int _Ms>
-	class et_x_from_row_block<0, _Ms> {
-		INLINE_FN_GEN1( void ) {
-			et_x_from_row<0, _Ms>::gen(b);
-		}
-	};
-	//expression template for diagonal block
-	template<int _CX, int _IY>
-	class et_diagonal_block {
-		INLINE_FN_GEN2( void ) {
-			et_diagonal_block<_CX, _IY-1>::gen(b, s);
-			b[eDiaIdx][_IY] = et_diagonal_indexer<2, _CX, _IY>::gen(b) ^ s;
-		}
-	};
-	template<int _CX >
-	class et_diagonal_block<_CX, 0> {
-		INLINE_FN_GEN2( void ) {
-			s = et_diagonal_indexer<2, _CX, -1>::gen(b);
-			b[eDiaIdx][0] = et_diagonal_indexer<2, _CX, 0>::gen(b) ^ s;
-		}
-	};
-	//expression template for recover x from diagonal line
-	template<int _IYMiss, int _IYDia, int _Ms>
-	class et_x_from_dia { // _IYMiss = _IYDia + _Ms-2
-		INLINE_FN_GEN2( void ) {
-			b[_Ms][_IYMiss] = b[eDiaIdx][_IYDia] ^ s
-				^ et_diagonal_indexer<2, _Ms-2, _IYDia>::gen(b)
-				^ et_diagonal_indexer<_Ms+1, _ND-_Ms-1, _IYMiss-1>::gen(b);
-		}
-	};
-	template<int _IYMiss, int _Ms>
-	class et_x_from_dia <_IYMiss, -1, _Ms> { // _IYMiss = _IYDia + _Ms-2
-		INLINE_FN_GEN2( void ) {
-			b[_Ms][_IYMiss] = /*b[eDiaIdx][_IYDia] ^*/ s
-				^ et_diagonal_indexer<2, _Ms-2, -1 >::gen(b)
-				^ et_diagonal_indexer<_Ms+1, _ND-_Ms-1, _IYMiss-1>::gen(b);
-		}
-	};
-	//expression template for recover x from diagonal block
-	template<int _IYMiss, int _IYDia, int _Ms>
-	class et_x_from_diagonal_block {
-		INLINE_FN_GEN2( void ) {
-			et_x_from_diagonal_block<_IYMiss-1, _IYDia-1, _Ms>::gen(b, s);
-			et_x_from_dia<_IYMiss, _IYDia, _Ms>::gen(b, s);
-		}
-	};
-	template<int _IYMiss, int _Ms>
-	class et_x_from_diagonal_block<_IYMiss, -1, _Ms> {
-		INLINE_FN_GEN2( void ) {
-			et_x_from_diagonal_block<_IYMiss-1, P-2, _Ms>::gen(b, s);
-			et_x_from_dia<_IYMiss, -1, _Ms>::gen(b, s);
-		}
-	};
-	template<  int _IYDia, int _Ms>
-	class et_x_from_diagonal_block<0, _IYDia, _Ms> {
-		INLINE_FN_GEN2( void ) {
-			s = b[eDiaIdx][_IYDia-1] ^ et_diagonal_indexer<2, _ND-2, _IYDia-1>::gen(b);
-			et_x_from_dia<0, _IYDia, _Ms>::gen(b, s);
-		}
-	};
-	template<  int _Ms>
-	class et_x_from_diagonal_block<0, 0, _Ms> {
-		INLINE_FN_GEN2( void ) {
-			s = /*b[eDiaIdx][_IYDia-1] ^*/ et_diagonal_indexer<2, _ND-2, -1>::gen(b);
-			et_x_from_dia<0, 0, _Ms>::gen(b, s);
-		}
-	};
-	template<  int _Ms>
-	class et_x_from_diagonal_block<0, -1, _Ms> {
-		INLINE_FN_GEN2( void ) {
-			s = b[eDiaIdx][P-2] ^ et_diagonal_indexer<2, _ND-2, P-2>::gen(b);
-			et_x_from_dia<0, -1, _Ms>::gen(b, s);
-		}
-	};
-	//expression template for recover Miss1 and Miss2
-	template<int _CY, int _IY, int _M1, int _M2>
-	class et_x1x2_block {
-		INLINE_FN_GEN2( void ) {
-			et_x1x2_block<_CY-1, (_IY-_M2+_M1+P)%P, _M1, _M2>::gen(b, s);
-			et_x_from_dia<_IY, (_IY+_M1-1)%P-1, _M1>::gen(b, s);
-			et_x_from_row<_IY, _M2>::gen(b); // now
-		}
-	};
-	template< int _IY, int _M1, int _M2>
-	class et_x1x2_block<1, _IY, _M1, _M2> {
-		INLINE_FN_GEN2( void ) {
-			s = et_syndrome<P-2, eDiaIdx, eRowIdx>::gen(b);
-			et_x_from_dia<_IY, (_IY+_M1-1)%P-1, _M1>::gen(b, s);
-			et_x_from_row<_IY, _M2>::gen(b); // now
-		}
-	};
-public: //public recover interface
-	#define run_head static int run(T** d, int c) { T* a[_ND], **b=a; for(int j=0; j<_ND; ++j) {a[j]=d[j];}
-
-	class recover_d { public: //recover diagonal parity
-		run_head
-		T syndrome = 0;
-		for( int i=c/(P-1); i>0; --i){
-			et_diagonal_block<_ND-2, P-2>::gen(b, syndrome);
-			et_add_ptr<eDiaIdx, 2, _ND-2>::gen(b);
-		}
-		return errOK;
-	}};
-	class recover_r { public: //recover row parity
-		run_head
-		for( int i=c/(P-1); i>0; --i) {
-			et_row_block<_ND-2, P-2>::gen(b);
-			et_add_ptr<eRowIdx, 2, _ND-2>::gen(b);
-		}
-		return errOK;
-	}};
-	template<int _Ms>
-	class recover_x_from_dia { public: //recover one data from diagonal
-		run_head
-		T syndrome = 0;
-		for( int i=c/(P-1); i>0; --i){
-			et_x_from_diagonal_block<P-2, (_Ms-3+P)%P-1, _Ms>::gen(b, syndrome);
-			et_add_ptr<eDiaIdx, 2, _ND-2>::gen(b);
-		}
-		return errOK;
-	}};
-	template<int _Ms>
-	class recover_x_from_row { public: //recover one data from row
-		run_head
-		for( int i=c/(P-1); i>0; --i){
-			et_x_from_row_block<P-2, _Ms>::gen(b);
-			et_add_ptr<eRowIdx, 2, _ND-2>::gen(b);
-		}
-		return errOK;
-	}};
-	template<int _Ms>
-	class recover_x { public: //recover one data, both from dia and from row are ok
-		static int run(T** b, int c) {            
-			return recover_x_from_dia<_Ms>::run(b, c);	//use diagonal here since recover_bigN need this!
-			//return recover_x_from_row<_Ms>::run(b, c);
-		}
-	};
-	class recover_dr { public: //recover both diagonal and row parity
-		run_head
-		T syndrome;
-		for( int i=c/(P-1); i>0; --i){
-			et_row_block<_ND-2, P-2>::gen(b);
-			et_diagonal_block<_ND-2, P-2>::gen(b, syndrome);
-			et_add_ptr<eDiaIdx, eRowIdx, _ND-1>::gen(b);
-		}
-		return errOK;
-	}};
-	template<int _Ms>
-	class recover_dx { public: //recover diagonal and one data
-		run_head
-		T syndrome;
-		for( int i=c/(P-1); i>0; --i){
-			et_x_from_row_block<P-2, _Ms>::gen(b);
-			et_diagonal_block<_ND-2, P-2>::gen(b, syndrome);
-			et_add_ptr<eDiaIdx, eRowIdx, _ND-1>::gen(b);
-		}
-		return errOK;
-	}};
-	template<int _Ms>
-	class recover_rx { public: //recover row and one data
-		run_head
-		T syndrome = 0;
-		for(int i=c/(P-1); i>0; --i){
-			et_x_from_diagonal_block<P-2, (_Ms-3+P)%P-1, _Ms>::gen(b, syndrome);
-			et_row_block<_ND-2, P-2>::gen(b);
-			et_add_ptr<eDiaIdx, eRowIdx, _ND-1>::gen(b);
-		}
-		return errOK;
-	}};
-	template<int _M1, int _M2>
-	class recover_xx { public:  //recover two data disk
-		run_head
-		T syndrome = 0;
-		for(int i=c/(P-1); i>0; --i){
-			et_x1x2_block<P-1, P-1-_M2+_M1, _M1, _M2>::gen(b, syndrome);
-			et_add_ptr<eDiaIdx, eRowIdx, _ND-1>::gen(b);
-		}
-		return errOK;
-	}};
-private: //to help generic wraper
-	template<int _M1, int _M2, bool> class traits_2 {public: typedef recover_xx<_M1, _M2> imp; };
-	template<int _M1, int _M2> class traits_2<_M1, _M2, true> {public: typedef recover_x<_M1> imp; };
-public:  //generic wraper, the NOUSE just to prevent gcc error
-	template<int _M1, int _M2, int NOUSE> class traits {public: typedef typename traits_2<_M1, _M2, _M1==_M2>::imp imp; };
-	template<int _Ms, int NOUSE> class traits<0, _Ms, NOUSE> {public: typedef recover_dx<_Ms> imp; };
-	template<int _Ms, int NOUSE> class traits<1, _Ms, NOUSE> {public: typedef recover_rx<_Ms> imp; };	
-	template<int NOUSE> class traits<0, 0, NOUSE> {public: typedef recover_d	imp; };
-	template<int NOUSE> class traits<1, 1, NOUSE> {public: typedef recover_r	imp; };
-	template<int NOUSE> class traits<0, 1, NOUSE> {public: typedef recover_dr	imp; };
-
-};//generic raid6 
+namespace raid6{
 
-//*****************************************************************************
-//class CFuncTableGenerator
-//Purpose:
-//  To generate function set in compile time
-//Naming:
-//  ND1, ND2: the first, second demention of array
-//  D1,D2,D3: current index for each demetion.
-//  _FN:      function pointer type 
-//*****************************************************************************
-template <class _FN, int ND2, int ND1>
-class CFuncTableGenerator {
-public:
-	typedef _FN table_t[][ND2][ND1]; 
-	template<int D3, int D2, int D1>
-	class et_recover_d31 { public:
-		static void gen(table_t t) {
-			et_recover_d31<D3, D2, D1-1>::gen(t);
-			t[D3-3][D1][D2] = CGenericRaid6<D3>::template traits<D1, D2, 0>::imp::run;
-		}
-	};
-	template<int D3, int D2 /*int D1*/>
-	class et_recover_d31<D3, D2, 0> { public:
-		static void gen(table_t t) {
-			t[D3-3][0][D2] = CGenericRaid6<D3>::template traits<0, D2, 0>::imp::run;
-		}
-	};
-	template<int D3, int D2, int D1>
-	class et_recover_d32 { public:
-		static void gen(table_t t) {
-			et_recover_d32<D3, D2-1, D2-1>::gen(t);
-			et_recover_d31<D3, D2, D1>::gen(t);
-		}
-	};
-	template<int D3, /*int D2,*/ int D1>
-	class et_recover_d32<D3, 0, D1> { public:
-		static void gen(table_t t) {
-			et_recover_d31<D3, 0, 0>::gen(t);
-		}
-	};
-	template<int D3, int D2, int D1>
-	class et_recover_d33 { public:
-		static void gen(table_t t) {
-			et_recover_d33<D3-1, D3-2, D3-2>::gen(t);
-			et_recover_d32<D3, D2, D1>::gen(t);
-		}
-	};
-	template</*int D3,*/ int D2, int D1>
-	class et_recover_d33<3, D2, D1> { public:
-		static void gen(table_t t) {
-			et_recover_d32<3, 2, 2>::gen(t);
-		}
-	};
-public:
-	static void init_recover( table_t fnSet ) {
-		enum {eFnInstNum = eImpDiskNum};	//Index of template recover function instanced by lib
-		et_recover_d33<eFnInstNum, eFnInstNum-1, eFnInstNum-1>::gen( fnSet );        
-	}
-};//end CFuncTableGenerator
 
 //*****************************************************************************
 // class CRaid6
 // the wrapper class for instantiate and using the generic raid6 recover engine.
 //*****************************************************************************
-R6RecoverFnType CRaid6::msRecoverFnSet[eImpDiskNum-2][eImpDiskNum][eImpDiskNum];
-int CRaid6::msInitialized = 0;
+constexpr SRaid6RecoverTable gRecoverFnSetScalar[ePrimeNum] = {
+	CRecoverTable< lane_scalar<5> >::table(), CRecoverTable< lane_scalar<17> >::table(), CRecoverTable< lane_scalar<257> >::table() };
+const SRaid6RecoverTable* const CRaid6::msRecoverFnSet[eKernelNum] = {
+	gRecoverFnSetScalar,	gRecoverFnSetSSE2,		gRecoverFnSetAVX2,		gRecoverFnSetAVX512 };
+constexpr SRaid6UpdateTable CRaid6::msUpdateFnSet[ePrimeNum] = {
+	CUpdateTable<5>::table(),	CUpdateTable<17>::table(),	CUpdateTable<257>::table() };
+constexpr R6LoopRecoverFnType gLoopRecoverFnSetScalar[ePrimeNum] = {
+	CLoopRaid6<5>::recover,		CLoopRaid6<17>::recover,	CLoopRaid6<257>::recover };
+const R6LoopRecoverFnType* const CRaid6::msLoopRecoverFnSet[eKernelNum] = {
+	gLoopRecoverFnSetScalar,	gLoopRecoverFnSetSSE2,	gLoopRecoverFnSetAVX2,	gLoopRecoverFnSetAVX512 };
+constexpr R6LoopUpdateFnType CRaid6::msLoopUpdateFnSet[ePrimeNum] = {
+	CLoopRaid6<5>::update,		CLoopRaid6<17>::update,		CLoopRaid6<257>::update };
+constexpr SRaid6VerifyTable CRaid6::msVerifyFnSet[ePrimeNum] = {
+	CVerifyTable<5>::table(),	CVerifyTable<17>::table(),	CVerifyTable<257>::table() };
+constexpr R6LoopVerifyFnType CRaid6::msLoopVerifyFnSet[ePrimeNum] = {
+	CLoopRaid6<5>::verify,		CLoopRaid6<17>::verify,		CLoopRaid6<257>::verify };
+constexpr R6LocateFnType CRaid6::msLocateFnSet[ePrimeNum] = {
+	CLoopRaid6<5>::locate,		CLoopRaid6<17>::locate,		CLoopRaid6<257>::locate };
+constexpr R6StarRecoverFnType CRaid6::msStarRecoverFnSet[ePrimeNum] = {
+	CLoopStar<5>::recover,		CLoopStar<17>::recover,		CLoopStar<257>::recover };
+const SRaid6CrcTable* CRaid6::msEncodeCrcFnSet = 0;
+R6CrcBlocksFnType CRaid6::msCrcBlocksFn = 0;
+const int CRaid6::msPrimes[ePrimeNum] = { 5, 17, 257 };
+static std::once_flag gInitOnce;
+int CRaid6::msKernelMask  = 0;
+int CRaid6::msBestKernel  = eKernelScalar;
+size_t CRaid6::msAutoTileBytes = raid6_config_tag::eDefTileBytes;
+size_t CRaid6::msAutoNtBytes = raid6_config_tag::eDefNtBytes;
+thread_local int gRunFlags = 0;
+
+//the widest simd kernel variant this cpu and os support
+static int probe_cpu_kernel() {
+#if defined(LIB_GCC4_1_OPTIMIZE_ENABLED) && ( defined(__x86_64__) || defined(__i386__) )
+	__builtin_cpu_init();
+	if( __builtin_cpu_supports("avx512f") )	return eKernelAVX512;
+	if( __builtin_cpu_supports("avx2") )	return eKernelAVX2;
+	if( __builtin_cpu_supports("sse2") )	return eKernelSSE2;
+#endif
+#if defined(LIB_VC10_OPTIMIZE_ENABLED) 
+	int info[4];
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+	__cpuid(info, 1);
+	int sse2 = (info[3]>>26) & 1;
+	int osAvx = 0, osAvx512 = 0;
+	if( (info[2]>>27) & 1 ) { //osxsave, check xmm/ymm/zmm state enabled by os
+		unsigned long long xcr0 = _xgetbv(0);
+		osAvx    = (xcr0 & 0x06)==0x06;
+		osAvx512 = (xcr0 & 0xe6)==0xe6;
+	}
+	if( maxLeaf>=7 ) {
+		__cpuidex(info, 7, 0);
+		if( osAvx512 && ((info[1]>>16) & 1) )	return eKernelAVX512;
+		if( osAvx && ((info[1]>>5) & 1) )		return eKernelAVX2;
+	}
+	if( sse2 ) return eKernelSSE2;
+#endif
+	return eKernelScalar;
+}
+
+//whether the cpu has the sse4.2 crc32 instruction
+static int probe_cpu_crc32c() {
+#if defined(LIB_GCC4_1_OPTIMIZE_ENABLED) && ( defined(__x86_64__) || defined(__i386__) )
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("sse4.2");
+#elif defined(LIB_VC10_OPTIMIZE_ENABLED) 
+	int info[4];
+	__cpuid(info, 1);
+	return (info[2]>>20) & 1;
+#else
+	return 0;
+#endif
+}
 
-CRaid6::CRaid6() {
+//crc32c, Castagnoli polynomial reflected, one byte a step
+static unsigned gCrcTable[256];
+static void init_crc_table() {
+	for(unsigned i=0; i<256; ++i) {
+		unsigned c = i;
+		for(int k=0; k<8; ++k) {
+			c = (c>>1) ^ ( (c&1)? 0x82F63B78u : 0 );
+		}
+		gCrcTable[i] = c;
+	}
+}
+static inline unsigned crc_bytes(unsigned crc, const unsigned char* p, size_t n) {
+	for(; n>0; --n, ++p) {
+		crc = gCrcTable[ (crc ^ *p) & 0xff ] ^ (crc>>8);
+	}
+	return crc;
+}
+static void crc_blocks_table(T** block, size_t numUnits, int numDisk, unsigned* crc) {
+	for(int j=0; j<numDisk; ++j) {
+		crc[j] = crc_bytes( crc[j], (const unsigned char*)block[j], numUnits*sizeof(T) );
+	}
+}
+
+//half the L2 size, the other half is left to what the caller keeps around
+static size_t probe_tile_bytes() {
+	if(raid6_config_tag::eTileBytes) return raid6_config_tag::eTileBytes;
+#if defined(LIB_GCC4_1_OPTIMIZE_ENABLED) && defined(_SC_LEVEL2_CACHE_SIZE)
+	long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+	if(l2>0) return (size_t)l2/2;
+#endif
+	return raid6_config_tag::eDefTileBytes;
+}
+
+//the last level cache size, a call above it would push its own inputs out anyway
+static size_t probe_nt_bytes() {
+	if(raid6_config_tag::eNtBytes) return raid6_config_tag::eNtBytes;
+#if defined(LIB_GCC4_1_OPTIMIZE_ENABLED) && defined(_SC_LEVEL3_CACHE_SIZE)
+	long l3 = sysconf(_SC_LEVEL3_CACHE_SIZE);
+	if(l3>0) return (size_t)l3;
+#endif
+	return raid6_config_tag::eDefNtBytes;
+}
+
+CRaid6::CRaid6() : mPrimeIdx(ePrime17), mPrime(17), mPool(0), mNuma(0), mTileBytes(0) {
+	mScratch.buf = 0;
+	mScratch.numUnits = 0;
 	init();
 }
 
 CRaid6::~CRaid6() {
+	delete mPool;
+	delete[] mScratch.buf;
+}
+
+//the cpu dependent statics, the function tables are constant already
+void CRaid6::init_once() {
+	//a simd variant is usable if the cpu runs it and it serves any prime
+	int cpuKernel = probe_cpu_kernel();
+	msKernelMask = 1<<eKernelScalar;
+	msBestKernel = eKernelScalar;
+	for(int k=eKernelSSE2; k<=cpuKernel; ++k) {
+		for(int p=0; p<ePrimeNum; ++p) {
+			if( msRecoverFnSet[k][p].fn[0][0][0] ) {
+				msKernelMask |= 1<<k;
+				msBestKernel  = k;
+			}
+		}
+	}
+
+	//the fused kernels are built on the crc32 instruction only, the table one is slower than a second pass
+	init_crc_table();
+	msEncodeCrcFnSet = 0;
+	msCrcBlocksFn = crc_blocks_table;
+	if( probe_cpu_crc32c() && get_crc_blocks_sse42() ) {
+		msCrcBlocksFn = get_crc_blocks_sse42();
+		msEncodeCrcFnSet = gEncodeCrcFnSetSSE42;
+	}
+
+	msAutoTileBytes = probe_tile_bytes();
+	msAutoNtBytes = probe_nt_bytes();
 }
 
 int CRaid6::init() {  
-	if(!msInitialized){
-		//static init msRecoverFnSet
-		memset( (void*)msRecoverFnSet, 0, sizeof(msRecoverFnSet) );
-		CFuncTableGenerator< R6RecoverFnType, eImpDiskNum, eImpDiskNum>::init_recover( msRecoverFnSet );
+	std::call_once(gInitOnce, init_once);
+	mKernel = msBestKernel;
+	mFamily = raid6_config_tag::eDefFamily;
+	mTileBytes = msAutoTileBytes;
+	mPrefetch = raid6_config_tag::eDoPrefetch;
+	return set_prime(P);
+}
+
+int CRaid6::set_kernel(int kernel) {
+	if( !is_kernel_supported(kernel) ) return errKernelNotSupported;
+	mKernel = kernel;
+	return errOK;
+}
+
+int CRaid6::get_kernel() const {
+	return mKernel;
+}
+
+int CRaid6::is_kernel_supported(int kernel) const {
+	return kernel>=0 && kernel<eKernelNum && ( msKernelMask & (1<<kernel) )!=0;
+}
 
-		msInitialized = 1;
+int CRaid6::set_family(int family) {
+	if(family<0 || family>=eFamilyNum) return errInvalidFamily;
+	mFamily = family;
+	return errOK;
+}
+
+int CRaid6::get_family() const {
+	return mFamily;
+}
+
+int CRaid6::set_thread_num(int numThread) {
+	if(numThread<0) return errFAIL;
+	if(numThread==get_thread_num()) return errOK;
+	delete mPool;
+	mPool = 0;
+	if(numThread>1) {
+		mPool = new CRaid6Pool(numThread, mNuma);
 	}
 	return errOK;
 }
 
-int  CRaid6::check_input(T** block, int numBytes, int numDisk, int missingDisk1, int missingDisk2) {
-	if(numDisk<3 || numDisk>eImpDiskNum )		return errInvalidDiskNum;
+int CRaid6::get_thread_num() const {
+	return mPool? mPool->get_thread_num() : 1;
+}
+
+//the workers are made again, pinned over the nodes or not
+int CRaid6::set_numa(int numa) {
+	numa = numa!=0;
+	if(numa==mNuma) return errOK;
+	mNuma = numa;
+	if(!mPool) return errOK;
+	int numThread = mPool->get_thread_num();
+	delete mPool;
+	mPool = new CRaid6Pool(numThread, mNuma);
+	return errOK;
+}
+
+int CRaid6::get_numa() const {
+	return mNuma;
+}
+
+int CRaid6::set_prime(int prime) {
+	for(int p=0; p<ePrimeNum; ++p) {
+		if(msPrimes[p]==prime) {
+			mPrimeIdx = p;
+			mPrime    = prime;
+			return errOK;
+		}
+	}
+	return errInvalidPrime;
+}
+
+int CRaid6::get_prime() const {
+	return mPrime;
+}
+
+int CRaid6::get_max_disk_num() const {
+	return mPrime+2;
+}
+
+int CRaid6::get_star_max_disk_num() const {
+	return mPrime+3;
+}
+
+size_t CRaid6::get_align_bytes() const {
+	return (mPrime-1)*sizeof(T);
+}
+
+size_t CRaid6::get_dia_bytes(size_t numBytes) const {
+	size_t groupBytes = get_align_bytes();
+	return (numBytes+groupBytes-1)/groupBytes*groupBytes;
+}
+
+int CRaid6::set_tile_bytes(size_t tileBytes) {
+	mTileBytes = tileBytes;
+	return errOK;
+}
+
+size_t CRaid6::get_tile_bytes() const {
+	return mTileBytes;
+}
+
+int CRaid6::set_prefetch(int prefetch) {
+	if(prefetch<0 || prefetch>=ePrefetchNum) return errInvalidPrefetch;
+	mPrefetch = prefetch;
+	return errOK;
+}
+
+int CRaid6::get_prefetch() const {
+	return mPrefetch;
+}
+
+//EnumRunFlag of a call on numBytes of each of numDisk disks. outputs read back right 
+//after stay in cache, as do the outputs of a call the last level cache holds in auto mode
+int CRaid6::get_run_flags(size_t numBytes, int numDisk, int readBack) const {
+	if(ePrefetchOff==mPrefetch) return 0;
+	if( readBack || (ePrefetchAuto==mPrefetch && numBytes*numDisk<=msAutoNtBytes) ) return eRunPrefetch;
+	return eRunPrefetch | eRunStream;
+}
+
+//base_type units of each disk in a tile, whole groups and at least one
+size_t CRaid6::get_tile_units(int numDisk) const {
+	if(!mTileBytes) return 0;
+	size_t groupUnits = mPrime-1;
+	size_t units = mTileBytes/sizeof(T)/numDisk/groupUnits*groupUnits;
+	return units? units : groupUnits;
+}
+
+int  CRaid6::check_input(T** block, size_t numBytes, int numDisk, int missingDisk1, int missingDisk2) {
+	int result = check_shape(block, numBytes, numDisk, missingDisk1, missingDisk2);
+	if(errOK!=result) return result;
+	if( (numBytes%get_align_bytes())!=0 )	return errSizeNotAligned;
+	enum {ePtrMask = sizeof(T)-1 };
+	for(int i=0; i<numDisk; ++i) {
+		if( ( (long)(void*)(block[i]) & ePtrMask) !=0 )		return errBufferNotAligned;
+	}
+	return errOK;
+}
+
+//the params recover() takes, buffers of any alignment and length
+int  CRaid6::check_shape(T** block, size_t numBytes, int numDisk, int missingDisk1, int missingDisk2) const {
+	if(numDisk<3 || numDisk>mPrime+2 )			return errInvalidDiskNum;
 	if(missingDisk1<0 || missingDisk1>=numDisk) return errInvalidMissIdx;
 	if(missingDisk2<0 || missingDisk2>=numDisk) return errInvalidMissIdx;
-	if( (numBytes<=0) || (numBytes%((P-1)*sizeof(T)))!=0 )	return errSizeNotAligned;
+	if( numBytes==0 )	return errSizeNotAligned;
 	if( !block ) return errNullBlockPointer;
-	enum {ePtrMask = sizeof(T)-1 };
 	for(int i=0; i<numDisk; ++i) {
 		if( 0==block[i]) return errNullBlockPointer;
-		if( ( (long)(void*)(block[i]) & ePtrMask) !=0 )		return errBufferNotAligned;
 	}
 	return errOK;
 }
 
+//whether the kernel could run on the buffers where they are. the simd kernels, unrolled
+//and loop, load and store unaligned lanes, the scalar ones need aligned base_type.
+int  CRaid6::is_in_place(T** block, int numDisk, int missingDisk1, int missingDisk2) const {
+	enum {ePtrMask = sizeof(T)-1 };
+	size_t addr = 0;
+	for(int i=0; i<numDisk; ++i) {
+		addr |= (size_t)(void*)block[i];
+	}
+	if( !(addr & ePtrMask) ) return 1;
+	if(mKernel==eKernelScalar) return 0;
+	if(mFamily==eFamilyUnroll && numDisk<=eImpDiskNum) {
+		return msRecoverFnSet[mKernel][mPrimeIdx].fn[numDisk-3][missingDisk1][missingDisk2]!=0;
+	}
+	return msLoopRecoverFnSet[mKernel][mPrimeIdx]!=0;
+}
+
+//the unrolled kernel of the engine's variant, the scalar one if the variant does not serve the prime
+R6RecoverFnType CRaid6::get_recover_fn(int numDisk, int missingDisk1, int missingDisk2) const {
+	if(numDisk>eImpDiskNum || mFamily==eFamilyLoop) return 0;
+	R6RecoverFnType fn = msRecoverFnSet[mKernel][mPrimeIdx].fn[numDisk-3][missingDisk1][missingDisk2];
+	return fn? fn : msRecoverFnSet[eKernelScalar][mPrimeIdx].fn[numDisk-3][missingDisk1][missingDisk2];
+}
+
+//the loop kernel of the engine's variant, the scalar one if the variant does not serve the prime
+R6LoopRecoverFnType CRaid6::get_loop_fn() const {
+	R6LoopRecoverFnType fn = msLoopRecoverFnSet[mKernel][mPrimeIdx];
+	return fn? fn : msLoopRecoverFnSet[eKernelScalar][mPrimeIdx];
+}
+
+//with 3 disks every block holds the same data, copy a surviving one. a missing 
+//diagonal parity gets the zero padding of the last partial group up to diaBytes
+static void recover_3disk(T** b, size_t numBytes, int missingDisk1, int missingDisk2, size_t diaBytes=0) {
+	int notMiss = missingDisk1>0? 0 : (missingDisk2<2? 2 : 1);
+	memcpy( (void*) b[missingDisk1], (void*)b[notMiss], numBytes);
+	memcpy( (void*) b[missingDisk2], (void*)b[notMiss], numBytes);			
+	if(eDiaIdx==missingDisk1 && diaBytes>numBytes) {
+		memset( (char*)b[eDiaIdx] + numBytes, 0, diaBytes-numBytes );
+	}
+}
+
+//the kernel of a (numDisk, miss1, miss2), the unrolled one if the table has it, the loop one if not
+struct SKernel {
+	R6RecoverFnType		fn;
+	R6LoopRecoverFnType	loop;
+	int					numDisk;
+	int					miss1;
+	int					miss2;
+	size_t				tileUnits;		//units of each disk per tile, 0 if not tiled
+	int					flags;			//EnumRunFlag of the call, see CRaid6::get_run_flags()
+
+	//the flags go to the kernels through the thread running them
+	int run_tile(T** b, size_t numUnits) const {
+		gRunFlags = flags;
+		return fn? fn(b, numUnits) : loop(b, numUnits, numDisk, miss1, miss2);
+	}
+	//a tile of every disk is done before moving on to the next one
+	int run(T** b, size_t numUnits) const {
+		if(!tileUnits || numUnits<=tileUnits) return run_tile(b, numUnits);
+		T* t[eLimitDiskNum+1];
+		int result = errOK;
+		for(size_t off=0; off<numUnits && errOK==result; off+=tileUnits) {
+			for(int i=numDisk-1; i>=0; --i) {
+				t[i] = b[i] + off;
+			}
+			result = run_tile(t, numUnits-off<tileUnits? numUnits-off : tileUnits);
+		}
+		return result;
+	}
+};
+
+//numUnits of the engine's scratch, grown on demand, what it held is not kept
+static T* get_scratch(SRaid6Scratch& scratch, size_t numUnits) {
+	if(scratch.numUnits<numUnits) {
+		delete[] scratch.buf;
+		scratch.buf = new T[numUnits];
+		scratch.numUnits = numUnits;
+	}
+	return scratch.buf;
+}
+
+//buffers of any alignment or length run through zero-padded whole groups in scratch, 
+//a tile at a time. the data and row parity of the padding are zero, the diagonal 
+//parity of it is not, every diagonal runs through all rows of the group. so the
+//diagonal parity buffer holds the last group whole, see get_dia_bytes().
+static int run_bounced(const SKernel& kernel, T** block, size_t numBytes, size_t groupUnits, SRaid6Scratch& scratch) {
+	size_t groupBytes = groupUnits*sizeof(T);
+	size_t chunkUnits = kernel.tileUnits;
+	if(!chunkUnits) chunkUnits = raid6_config_tag::eDefTileBytes/sizeof(T)/kernel.numDisk/groupUnits*groupUnits;
+	if(chunkUnits<groupUnits) chunkUnits = groupUnits;
+	size_t wholeUnits = (numBytes+groupBytes-1)/groupBytes*groupUnits;
+	if(chunkUnits>wholeUnits) chunkUnits = wholeUnits;
+	size_t chunkBytes = chunkUnits*sizeof(T);
+	T* buf = get_scratch( scratch, chunkUnits*kernel.numDisk );
+	T* b[eLimitDiskNum+1];
+	for(int i=kernel.numDisk-1; i>=0; --i) {
+		b[i] = buf + i*chunkUnits;
+	}
+	int result = errOK;
+	for(size_t off=0; off<numBytes && errOK==result; off+=chunkBytes) {
+		size_t n = numBytes-off<chunkBytes? numBytes-off : chunkBytes;
+		size_t units = (n+groupBytes-1)/groupBytes*groupUnits;
+		for(int i=kernel.numDisk-1; i>=0; --i) {
+			if(i==kernel.miss1 || i==kernel.miss2) continue;
+			size_t len = i==eDiaIdx? units*sizeof(T) : n;
+			memcpy( (void*)b[i], (char*)block[i]+off, len );
+			memset( (char*)b[i]+len, 0, units*sizeof(T)-len );
+		}
+		result = kernel.run_tile(b, units);
+		memcpy( (char*)block[kernel.miss1]+off, (void*)b[kernel.miss1], kernel.miss1==eDiaIdx? units*sizeof(T) : n );
+		if(kernel.miss2!=kernel.miss1) {
+			memcpy( (char*)block[kernel.miss2]+off, (void*)b[kernel.miss2], n );
+		}
+	}
+	return result;
+}
+
+//the whole groups in place if the kernel could, the tail group and the buffers it could not through scratch
+static int run_stripe(const SKernel& kernel, int inPlace, T** block, size_t numBytes, size_t groupUnits, SRaid6Scratch& scratch) {
+	size_t groupBytes = groupUnits*sizeof(T);
+	size_t bulkBytes  = inPlace? numBytes/groupBytes*groupBytes : 0;
+	int result = bulkBytes? kernel.run(block, bulkBytes/sizeof(T)) : errOK;
+	if(errOK==result && bulkBytes<numBytes) {
+		T* t[eLimitDiskNum+1];
+		for(int i=kernel.numDisk-1; i>=0; --i) {
+			t[i] = (T*)( (char*)block[i] + bulkBytes );
+		}
+		result = run_bounced(kernel, t, numBytes-bulkBytes, groupUnits, scratch);
+	}
+	return result;
+}
+
+//one multi-threaded recover call, each task runs the kernel on its own slice of groups
+struct SRecoverJob {
+	SKernel				kernel;
+	T**					block;
+	size_t				numUnits;		//base_type units of each disk
+	size_t				taskUnits;		//base_type units of each disk per task
+	std::atomic<int>	result;
+};
+
+static void recover_task(void* arg, int taskIdx) {
+	SRecoverJob* job = (SRecoverJob*)arg;
+	T* b[eLimitDiskNum+1];
+	size_t first = taskIdx*job->taskUnits;
+	size_t count = job->numUnits-first < job->taskUnits? job->numUnits-first : job->taskUnits;
+	for(int i=job->kernel.numDisk-1; i>=0; --i) {
+		b[i] = job->block[i] + first;
+	}
+	int result = job->kernel.run(b, count);
+	if(errOK!=result) job->result = result;
+}
+
 //*****************************************************************************
 //Function:
 //		recover missing block, other block's data not changed. 
 //Param:
-//		block:		buffers on all disks, buffer ptr should aligned to base_type, 
-//					index from 0~ numDisk-1.
-//		numBytes:	length of each buffer, length should aligned to base_type.
-//		numDisk:	total disk number.
+//		block:		buffers on all disks, any alignment, index from 0~ numDisk-1.
+//		numBytes:	length of each buffer, any length. the last partial group is 
+//					taken as padded with zero on every disk, the diagonal parity
+//					buffer should hold get_dia_bytes(numBytes).
+//		numDisk:	total disk number, 3~prime+2.
 //		missingDisk1:	index of first missing disk.
 //		missingDisk2:	index of second missing disk, set same to missingDisk1 if 
 //						one disk missing.
 //Return:
 //		return errOK if success, otherwise, return error code
 //Comment:
-//		note we may have faster impl if only some change happend on some disk, this
-//		is what the update() interface what to do. any way you can always use the 
-//		recover function to update the parities.
+//		if only one data disk changed, update() refreshes the parities without 
+//		reading the other data disks. any way you can always use the recover 
+//		function to update the parities.
+//		buffers passing check_input() run in place all through, the last partial
+//		group, and unaligned buffers the kernel variant could not load, are 
+//		staged through scratch.
 //*****************************************************************************
-int  CRaid6::recover(T** block, int numBytes, int numDisk, int missingDisk1, int missingDisk2){
-	T* b[eMaxDiskNum+1];
-	int result = check_input(block, numBytes, numDisk, missingDisk1, missingDisk2);    
+int  CRaid6::recover(T** block, size_t numBytes, int numDisk, int missingDisk1, int missingDisk2){
+	T* b[eLimitDiskNum+1];
+	int result = check_shape(block, numBytes, numDisk, missingDisk1, missingDisk2);    
 	if (errOK==result) {		
 		for(int i=numDisk-1; i>=0; --i) {
 			b[i] = block[i];
@@ -483,23 +530,611 @@ int  CRaid6::recover(T** block, int numBytes, int numDisk, int missingDisk1, int
 		if(missingDisk1 > missingDisk2) {
 			int tmp = missingDisk1;
 			missingDisk1 = missingDisk2;
-			missingDisk2 = missingDisk1;
+			missingDisk2 = tmp;
 		}
+		SKernel kernel = { get_recover_fn(numDisk, missingDisk1, missingDisk2),
+			get_loop_fn(), numDisk, missingDisk1, missingDisk2, get_tile_units(numDisk), 
+			get_run_flags(numBytes, numDisk, 0) };
+		size_t groupBytes = get_align_bytes();
+		size_t taskBytes  = raid6_config_tag::eParallelBytes<groupBytes? groupBytes : raid6_config_tag::eParallelBytes/groupBytes*groupBytes;
 		//simple with 3 disks
+		int inPlace = is_in_place(b, numDisk, missingDisk1, missingDisk2);
+		size_t bulkBytes = numBytes/groupBytes*groupBytes;
+		if(numDisk==3) {
+			recover_3disk(b, numBytes, missingDisk1, missingDisk2, get_dia_bytes(numBytes));
+		}
+		else if(mPool && inPlace && bulkBytes>taskBytes) {
+			//groups are independent, split them over the workers in cache sized slices
+			SRecoverJob job;
+			job.kernel = kernel;
+			job.block = b;
+			job.numUnits = bulkBytes/sizeof(T);
+			job.taskUnits = taskBytes/sizeof(T);
+			job.result = errOK;
+			int numTask = (int)( (job.numUnits + job.taskUnits-1)/job.taskUnits );
+			std::vector<int> taskNode;
+			if(mNuma) {
+				//each slice runs on the node its first surviving disk's pages are on
+				int src = 0;
+				while(src==missingDisk1 || src==missingDisk2) ++src;
+				std::vector<const void*> addr(numTask);
+				for(int t=0; t<numTask; ++t) {
+					addr[t] = b[src] + t*job.taskUnits;
+				}
+				taskNode.resize(numTask);
+				CRaid6Numa::get_mem_node(&addr[0], numTask, &taskNode[0]);
+			}
+			mPool->parallel_for(recover_task, &job, numTask, mNuma? &taskNode[0] : 0);
+			result = job.result;
+			if(errOK==result && bulkBytes<numBytes) {
+				for(int i=numDisk-1; i>=0; --i) {
+					b[i] = (T*)( (char*)block[i] + bulkBytes );
+				}
+				result = run_bounced(kernel, b, numBytes-bulkBytes, mPrime-1, mScratch);
+			}
+		}
+		else {
+			result = run_stripe(kernel, inPlace, b, numBytes, mPrime-1, mScratch);
+		}
+	}
+	return result;
+}
+
+//*****************************************************************************
+//Function:
+//		recover up to three missing blocks of a STAR array, other block's data 
+//		not changed.
+//Param:
+//		block:		buffers on all disks, base_type aligned. block[eDiaIdx] and
+//					block[eRowIdx] as recover(), the data disks 2~ numDisk-2, 
+//					block[numDisk-1] the anti-diagonal parity.
+//		numBytes:	length of each buffer, aligned to base_type*(prime-1).
+//		numDisk:	total disk number, 4~prime+3.
+//		missingDisk1, missingDisk2, missingDisk3:	index of the missing disks, 
+//					repeat one if fewer are missing.
+//Return:
+//		return errOK if success, otherwise, return error code
+//Comment:
+//		the first numDisk-1 disks are an array of recover() as they are, adding
+//		the anti-diagonal parity disk to it takes a recover_star() of that disk.
+//*****************************************************************************
+int  CRaid6::recover_star(T** block, size_t numBytes, int numDisk, int missingDisk1, int missingDisk2, int missingDisk3) {
+	int miss[3] = { missingDisk1, missingDisk2, missingDisk3 };
+	int numMiss = 0;
+	if(numDisk<4 || numDisk>get_star_max_disk_num() )	return errInvalidDiskNum;
+	for(int m=0; m<3; ++m) {
+		if(miss[m]<0 || miss[m]>=numDisk)		return errInvalidMissIdx;
+		int j = 0;
+		while(j<numMiss && miss[j]!=miss[m]) ++j;
+		if(j==numMiss) miss[numMiss++] = miss[m];
+	}
+	if( (numBytes==0) || (numBytes%get_align_bytes())!=0 )	return errSizeNotAligned;
+	if( !block ) return errNullBlockPointer;
+	enum {ePtrMask = sizeof(T)-1 };
+	for(int i=0; i<numDisk; ++i) {
+		if( 0==block[i]) return errNullBlockPointer;
+		if( ( (long)(void*)(block[i]) & ePtrMask) !=0 )		return errBufferNotAligned;
+	}
+	return msStarRecoverFnSet[mPrimeIdx](block, numBytes/sizeof(T), numDisk, miss, numMiss);
+}
+
+//*****************************************************************************
+//Function:
+//		recover into buffers of the caller's, the members are only read.
+//Param:
+//		block:		buffers on all disks, as recover(). the missing disks' 
+//					entries are not used, they may be 0.
+//		out1:		the missing disk missingDisk1 is written here, the whole
+//					get_dia_bytes(numBytes) if it is the diagonal parity.
+//		out2:		the missing disk missingDisk2, not used if it is missingDisk1.
+//		others:		same as recover().
+//Return:
+//		return errOK if success, otherwise, return error code
+//Comment:
+//		the kernels read the surviving disks and write the missing ones only,
+//		so this is recover() on a pointer array with the outputs swapped in. 
+//		rebuild straight into a send buffer or a spare disk's write buffer.
+//*****************************************************************************
+int  CRaid6::recover_to(const T* const* block, size_t numBytes, int numDisk, int missingDisk1, int missingDisk2, T* out1, T* out2) {
+	if(numDisk<3 || numDisk>mPrime+2 )			return errInvalidDiskNum;
+	if(missingDisk1<0 || missingDisk1>=numDisk) return errInvalidMissIdx;
+	if(missingDisk2<0 || missingDisk2>=numDisk) return errInvalidMissIdx;
+	if( !block ) return errNullBlockPointer;
+	T* b[eLimitDiskNum+1];
+	for(int i=numDisk-1; i>=0; --i) {
+		b[i] = const_cast<T*>( block[i] );
+	}
+	b[missingDisk2] = out2;
+	b[missingDisk1] = out1;
+	return recover(b, numBytes, numDisk, missingDisk1, missingDisk2);
+}
+
+//*****************************************************************************
+//Function:
+//		the part of the members a degraded read of [offset, offset+length) on 
+//		the missing disks needs. a group is solved as a whole, the diagonal 
+//		syndrome and the zig-zag of two data disks run over all its rows.
+//Param:
+//		numDisk ~ missingDisk2:	same as recover().
+//		offset, length:	bytes wanted of the missing disks, any alignment.
+//		range:		out: the groups covering them, the same range on every disk.
+//					if the members end in a partial group, read up to their end,
+//					the diagonal parity to get_dia_bytes().
+//		needDisk:	out, may be 0: numDisk entries, 1 if the disk should be read
+//					over range. the missing disks and a parity not used are 0.
+//Return:
+//		return errOK if success, otherwise, return error code
+//*****************************************************************************
+int  CRaid6::get_range(int numDisk, int missingDisk1, int missingDisk2, size_t offset, size_t length, 
+	SRaid6Range* range, unsigned char* needDisk) const {
+	if(numDisk<3 || numDisk>mPrime+2 )			return errInvalidDiskNum;
+	if(missingDisk1<0 || missingDisk1>=numDisk) return errInvalidMissIdx;
+	if(missingDisk2<0 || missingDisk2>=numDisk) return errInvalidMissIdx;
+	if( !range ) return errNullBlockPointer;
+	if( 0==length ) return errSizeNotAligned;
+	size_t groupBytes = get_align_bytes();
+	range->offset   = offset/groupBytes*groupBytes;
+	range->numBytes = ( offset+length - range->offset + groupBytes-1 )/groupBytes*groupBytes;
+	if(needDisk) {
+		int m1 = missingDisk1<missingDisk2? missingDisk1 : missingDisk2;
+		int m2 = missingDisk1<missingDisk2? missingDisk2 : missingDisk1;
+		for(int i=0; i<numDisk; ++i) {
+			needDisk[i] = i!=m1 && i!=m2;
+		}
+		if(numDisk==3) {
+			//copied from one survivor, see recover_3disk()
+			int notMiss = m1>0? 0 : (m2<2? 2 : 1);
+			for(int i=0; i<numDisk; ++i) {
+				needDisk[i] = i==notMiss;
+			}
+		}
+		else if(m2<2) {
+			//parities are built from the data only
+			needDisk[eDiaIdx] = needDisk[eRowIdx] = 0;
+		}
+		else if(m1==m2) {
+			//one data disk is solved from the diagonal parity by every kernel
+			needDisk[eRowIdx] = 0;
+		}
+	}
+	return errOK;
+}
+
+//*****************************************************************************
+//Function:
+//		degraded read, recover only the groups of the missing disks covering
+//		[offset, offset+length), see get_range().
+//Param:
+//		block:		buffers of the whole members, as recover(). only the range
+//					of the needed disks is read, only the range of the missing 
+//					disks is written.
+//		numBytes:	length of each buffer, offset+length should not pass it.
+//		others:		same as recover() and get_range().
+//Return:
+//		return errOK if success, otherwise, return error code
+//Comment:
+//		if only the range was read into buffers of its own, recover() them
+//		directly with range.numBytes.
+//*****************************************************************************
+int  CRaid6::recover_range(T** block, size_t numBytes, int numDisk, int missingDisk1, int missingDisk2, size_t offset, size_t length) {
+	int result = check_shape(block, numBytes, numDisk, missingDisk1, missingDisk2);
+	if(errOK!=result) return result;
+	if(offset>=numBytes || length>numBytes-offset) return errSizeNotAligned;
+	SRaid6Range range;
+	result = get_range(numDisk, missingDisk1, missingDisk2, offset, length, &range, 0);
+	if(errOK!=result) return result;
+	T* b[eLimitDiskNum+1];
+	for(int i=numDisk-1; i>=0; --i) {
+		b[i] = (T*)( (char*)block[i] + range.offset );
+	}
+	//the last group may be partial
+	size_t rangeBytes = numBytes-range.offset<range.numBytes? numBytes-range.offset : range.numBytes;
+	return recover(b, rangeBytes, numDisk, missingDisk1, missingDisk2);
+}
+
+//a member's read/write position in its segment list
+struct SSgCursor {
+	const SRaid6Segment*	seg;
+	size_t					off;			//bytes into *seg
+
+	//bytes left in the current segment, the used up ones skipped
+	size_t avail() {
+		while(off==seg->numBytes) {
+			++seg;
+			off = 0;
+		}
+		return seg->numBytes-off;
+	}
+	void* ptr() const {
+		return (char*)seg->base + off;
+	}
+	void skip(size_t n) {
+		while(n) {
+			size_t k = avail()<n? avail() : n;
+			off += k;
+			n -= k;
+		}
+	}
+	//copy n bytes out of the list or into it, moving on
+	void gather(void* dst, size_t n) {
+		while(n) {
+			size_t k = avail()<n? avail() : n;
+			memcpy(dst, ptr(), k);
+			dst = (char*)dst + k;
+			off += k;
+			n -= k;
+		}
+	}
+	void scatter(const void* src, size_t n) {
+		while(n) {
+			size_t k = avail()<n? avail() : n;
+			memcpy(ptr(), src, k);
+			src = (const char*)src + k;
+			off += k;
+			n -= k;
+		}
+	}
+};
+
+//*****************************************************************************
+//Function:
+//		recover with every member given as a list of segments, as iovec.
+//Param:
+//		disk:		segment list of each disk, index from 0~ numDisk-1. the 
+//					segments of a disk add up to at least numBytes, the diagonal 
+//					parity's to get_dia_bytes(numBytes), as recover().
+//		others:		same as recover().
+//Return:
+//		return errOK if success, otherwise, return error code
+//Comment:
+//		the runs of whole groups where every member's segment goes on are 
+//		recovered where they are, as recover(). only a group crossing a segment 
+//		boundary of some member, and the last partial group, are copied through 
+//		one group of scratch. segments of 4KB pages are all whole groups for the
+//		primes compiled in, so a page list rebuild copies nothing. it runs on 
+//		the calling thread.
+//*****************************************************************************
+int  CRaid6::recover_sg(const SRaid6SgList* disk, size_t numBytes, int numDisk, int missingDisk1, int missingDisk2) {
+	if(numDisk<3 || numDisk>mPrime+2 )			return errInvalidDiskNum;
+	if(missingDisk1<0 || missingDisk1>=numDisk) return errInvalidMissIdx;
+	if(missingDisk2<0 || missingDisk2>=numDisk) return errInvalidMissIdx;
+	if( numBytes==0 )	return errSizeNotAligned;
+	if( !disk ) return errNullBlockPointer;
+	SSgCursor cur[eLimitDiskNum+1];
+	for(int i=0; i<numDisk; ++i) {
+		size_t total = 0;
+		if( !disk[i].seg || disk[i].numSeg<=0 ) return errNullBlockPointer;
+		for(int j=0; j<disk[i].numSeg; ++j) {
+			if( !disk[i].seg[j].base && disk[i].seg[j].numBytes ) return errNullBlockPointer;
+			total += disk[i].seg[j].numBytes;
+		}
+		if( total<(i==eDiaIdx? get_dia_bytes(numBytes) : numBytes) ) return errSizeNotAligned;
+		cur[i].seg = disk[i].seg;
+		cur[i].off = 0;
+	}
+	if(missingDisk1 > missingDisk2) {
+		int tmp = missingDisk1;
+		missingDisk1 = missingDisk2;
+		missingDisk2 = tmp;
+	}
+	SKernel kernel = { get_recover_fn(numDisk, missingDisk1, missingDisk2),
+		get_loop_fn(), numDisk, missingDisk1, missingDisk2, get_tile_units(numDisk), 
+		get_run_flags(numBytes, numDisk, 0) };
+	size_t groupUnits = mPrime-1;
+	size_t groupBytes = get_align_bytes();
+	T* b[eLimitDiskNum+1];
+	int result = errOK;
+	for(size_t done=0; done<numBytes && errOK==result; ) {
+		size_t run = numBytes-done;
+		for(int i=numDisk-1; i>=0; --i) {
+			size_t avail = cur[i].avail();
+			if(avail<run) run = avail;
+		}
+		run -= run%groupBytes;
+		if(run) {
+			//whole groups contiguous on every member, in place
+			for(int i=numDisk-1; i>=0; --i) {
+				b[i] = (T*)cur[i].ptr();
+				cur[i].skip(run);
+			}
+			if(numDisk==3) {
+				recover_3disk(b, run, missingDisk1, missingDisk2);
+			}
+			else {
+				result = run_stripe(kernel, is_in_place(b, numDisk, missingDisk1, missingDisk2), b, run, groupUnits, mScratch);
+			}
+			done += run;
+			continue;
+		}
+		//one group across a segment boundary or the last partial one, zero padded as run_bounced()
+		size_t n = numBytes-done<groupBytes? numBytes-done : groupBytes;
+		T* buf = get_scratch( mScratch, groupUnits*numDisk );
+		for(int i=numDisk-1; i>=0; --i) {
+			b[i] = buf + i*groupUnits;
+			if(i==missingDisk1 || i==missingDisk2) continue;
+			size_t len = i==eDiaIdx? groupBytes : n;
+			cur[i].gather( (void*)b[i], len );
+			memset( (char*)b[i]+len, 0, groupBytes-len );
+		}
 		if(numDisk==3) {
-			int notMiss = missingDisk1>0? 0 : (missingDisk2<2? 2 : 1);
-			memcpy( (void*) b[missingDisk1], (void*)b[notMiss], numBytes);
-			memcpy( (void*) b[missingDisk2], (void*)b[notMiss], numBytes);			
+			recover_3disk(b, groupBytes, missingDisk1, missingDisk2);
 		}
-		else if(msRecoverFnSet[numDisk-3][missingDisk1][missingDisk2]) {
-			result = msRecoverFnSet[numDisk-3][missingDisk1][missingDisk2](b, numBytes/sizeof(T) );
+		else {
+			result = kernel.run_tile(b, groupUnits);
 		}
-		else { //should never go here
-			printf("recover function not set, index=(%d,%d,%d)!", numDisk, missingDisk1, missingDisk2);
-			result = errFAIL;
+		cur[missingDisk1].scatter( (void*)b[missingDisk1], missingDisk1==eDiaIdx? groupBytes : n );
+		if(missingDisk2!=missingDisk1) {
+			cur[missingDisk2].scatter( (void*)b[missingDisk2], n );
 		}
+		done += n;
 	}
 	return result;
 }
 
-}//end namspace raid6
\ No newline at end of file
+//*****************************************************************************
+//Function:
+//		recover many stripes in one call. stripes of the same (numDisk, miss1, 
+//		miss2) are run back to back through one kernel, the per call checking
+//		and dispatching of recover() is paid once per stripe at most.
+//Param:
+//		stripes:	stripe descriptors, each as the recover() params. the result
+//					of each stripe is set to its own return code.
+//		numStripe:	number of stripes.
+//Return:
+//		return errOK if all stripes success, otherwise, the first error code met.
+//		stripes with a bad param are skipped, the others are still recovered.
+//*****************************************************************************
+int  CRaid6::recover_batch(SRaid6Stripe* stripes, int numStripe) {
+	if(numStripe<=0) return numStripe==0? errOK : errFAIL;
+	if(!stripes) return errNullBlockPointer;
+
+	//sort by kernel index, the stripe index in the low 32 bits keeps the submit order in a kernel
+	std::vector<long long> order;
+	order.reserve(numStripe);
+	int result = errOK;
+	for(int i=0; i<numStripe; ++i) {
+		SRaid6Stripe& s = stripes[i];
+		s.result = check_shape(s.block, s.numBytes, s.numDisk, s.missingDisk1, s.missingDisk2);
+		if(errOK!=s.result) {
+			if(errOK==result) result = s.result;
+			continue;
+		}
+		int m1 = s.missingDisk1<s.missingDisk2? s.missingDisk1 : s.missingDisk2;
+		int m2 = s.missingDisk1<s.missingDisk2? s.missingDisk2 : s.missingDisk1;
+		long long key = ( (s.numDisk-3)*eLimitDiskNum + m1 )*eLimitDiskNum + m2;
+		order.push_back( (key<<32) | i );
+	}
+	std::sort(order.begin(), order.end());
+
+	for(size_t i=0, n=order.size(); i<n; ) {
+		int key = (int)(order[i]>>32);
+		int numDisk = key/(eLimitDiskNum*eLimitDiskNum) + 3;
+		int m1 = key/eLimitDiskNum%eLimitDiskNum;
+		int m2 = key%eLimitDiskNum;
+		SKernel kernel = { get_recover_fn(numDisk, m1, m2),
+			get_loop_fn(), numDisk, m1, m2, get_tile_units(numDisk), 0 };
+		for(; i<n && (int)(order[i]>>32)==key; ++i) {
+			SRaid6Stripe& s = stripes[ (int)(order[i] & 0xffffffff) ];
+			if(numDisk==3) {
+				recover_3disk(s.block, s.numBytes, m1, m2, get_dia_bytes(s.numBytes));
+			}
+			else {
+				kernel.flags = get_run_flags(s.numBytes, numDisk, 0);
+				s.result = run_stripe(kernel, is_in_place(s.block, numDisk, m1, m2), s.block, s.numBytes, mPrime-1, mScratch);
+				if(errOK!=s.result && errOK==result) result = s.result;
+			}
+		}
+	}
+	return result;
+}
+
+//*****************************************************************************
+//Function:
+//		read-modify-write both parities after one data disk changed, other data
+//		disks are not needed.
+//Param:
+//		parity:		parity buffers, parity[eDiaIdx] and parity[eRowIdx], updated in place.
+//		numBytes:	length of each buffer, length should aligned to base_type*(prime-1).
+//		dataOld:	data on disk dataIdx before the change, not used by eUpdateDiff.
+//		dataNewOrDiff:	the new data for eUpdateNew, or old^new for eUpdateDiff.
+//		dataIdx:	index of the changed data disk, 2~numDisk-1.
+//		mode:		see EnumUpdateMode.
+//Return:
+//		return errOK if success, otherwise, return error code
+//Comment:
+//		writing the new data to disk dataIdx is up to the caller.
+//*****************************************************************************
+int  CRaid6::update(T** parity, size_t numBytes, T* dataOld, T* dataNewOrDiff, int dataIdx, int mode) {
+	if(mode<0 || mode>=eUpdateModeNum)			return errInvalidUpdateMode;
+	if(dataIdx<2 || dataIdx>=mPrime+2)			return errInvalidMissIdx;
+	if( (numBytes==0) || (numBytes%get_align_bytes())!=0 )	return errSizeNotAligned;
+	if( !parity ) return errNullBlockPointer;
+
+	T* b[4] = { parity[eDiaIdx], parity[eRowIdx], mode==eUpdateDiff? dataNewOrDiff : dataOld, dataNewOrDiff };
+	enum {ePtrMask = sizeof(T)-1 };
+	for(int i=0; i<4; ++i) {
+		if( 0==b[i]) return errNullBlockPointer;
+		if( ( (long)(void*)(b[i]) & ePtrMask) !=0 )		return errBufferNotAligned;
+	}
+	R6UpdateFnType fn = dataIdx<eImpDiskNum? msUpdateFnSet[mPrimeIdx].fn[mode][dataIdx] : 0;
+	return fn? fn(b, numBytes/sizeof(T) ) : msLoopUpdateFnSet[mPrimeIdx](b, numBytes/sizeof(T), dataIdx, mode);
+}
+
+//*****************************************************************************
+//Function:
+//		check both parities against the data in one read only pass.
+//Param:
+//		block:		buffers on all disks, as recover(). nothing is written.
+//		numBytes:	length of each buffer, length should aligned to base_type*(prime-1).
+//		numDisk:	total disk number, 3~prime+2.
+//		bad:		out: the first maxBad mismatching groups, in offset order. may be 0.
+//		maxBad:		entries of bad.
+//		numBad:		out: number of mismatching groups, may be 0. if 0 the scan
+//					stops once bad is full.
+//Return:
+//		return errOK if both parities match, errParityMismatch if any group does 
+//		not, otherwise, return error code
+//*****************************************************************************
+int  CRaid6::verify(T** block, size_t numBytes, int numDisk, SRaid6Mismatch* bad, int maxBad, int* numBad) {
+	return scan(block, numBytes, numDisk, bad, maxBad, numBad, 0);
+}
+
+//*****************************************************************************
+//Function:
+//		scrub, as verify(), and each bad group is put right in place if one
+//		disk's corruption explains both parity mismatches.
+//Param:
+//		same as verify(), the whole buffers are always scanned. bad[i].disk is
+//		the disk rewritten in that group, -1 if the group was left as it is.
+//Return:
+//		return errOK if both parities match, errParityMismatch if bad groups 
+//		were found and all corrected, errUncorrectable if any group could not
+//		be located to one disk, otherwise, return error code
+//Comment:
+//		a group with more than one bad disk may by chance look like a single
+//		disk corruption, scrub() then rewrites the wrong disk. it is the limit 
+//		of two parities.
+//*****************************************************************************
+int  CRaid6::scrub(T** block, size_t numBytes, int numDisk, SRaid6Mismatch* bad, int maxBad, int* numBad) {
+	return scan(block, numBytes, numDisk, bad, maxBad, numBad, 1);
+}
+
+int  CRaid6::scan(T** block, size_t numBytes, int numDisk, SRaid6Mismatch* bad, int maxBad, int* numBad, int repair) {
+	int result = check_input(block, numBytes, numDisk, 0, 0);
+	if(numBad) *numBad = 0;
+	if(errOK!=result) return result;
+	if(!bad) maxBad = 0;
+
+	T* b[eLimitDiskNum+1];
+	for(int i=numDisk-1; i>=0; --i) {
+		b[i] = block[i];
+	}
+	R6VerifyFnType fn = numDisk<=eImpDiskNum? msVerifyFnSet[mPrimeIdx].fn[numDisk-3] : 0;
+	R6LoopVerifyFnType loop = msLoopVerifyFnSet[mPrimeIdx];
+	size_t numUnits = numBytes/sizeof(T);
+	size_t groupUnits = mPrime-1;
+	size_t off = 0;
+	int count = 0;
+	int located = 1;
+	gRunFlags = get_run_flags(numBytes, numDisk, 1);
+	//a kernel call stops at the first bad group, go on after it
+	while(off<numUnits) {
+		size_t at = 0;
+		int mask = fn? fn(b, numUnits-off, &at) : loop(b, numUnits-off, numDisk, &at);
+		if(!mask) break;
+		off += at;
+		for(int i=numDisk-1; i>=0; --i) {
+			b[i] = block[i] + off;
+		}
+		int disk = -1;
+		if(repair) {
+			//the group is still in cache, solve the bad disk from the others
+			disk = msLocateFnSet[mPrimeIdx](b, numDisk);
+			if(disk>=0) {
+				SKernel kernel = { get_recover_fn(numDisk, disk, disk),
+					get_loop_fn(), numDisk, disk, disk, 0, get_run_flags(numBytes, numDisk, 1) };
+				kernel.run(b, groupUnits);
+			}
+			else {
+				located = 0;
+			}
+		}
+		if(count<maxBad) {
+			bad[count].offset = off*sizeof(T);
+			bad[count].mask   = mask;
+			bad[count].disk   = disk;
+		}
+		++count;
+		if(!repair && !numBad && count>=maxBad) break;
+		off += groupUnits;
+		for(int i=numDisk-1; i>=0; --i) {
+			b[i] = block[i] + off;
+		}
+	}
+	if(numBad) *numBad = count;
+	return !count? errOK : ( located? errParityMismatch : errUncorrectable );
+}
+
+
+//*****************************************************************************
+//Function:
+//		recover as recover(), and run the crc32c of every disk's buffer while
+//		it is in cache.
+//Param:
+//		block ~ missingDisk2:	same as recover().
+//		crc:		in/out: crc32c of each disk, numDisk entries. 0 to start, or
+//					the result of the previous piece to chain the buffers.
+//Return:
+//		return errOK if success, otherwise, return error code
+//Comment:
+//		building both parities (eDiaIdx, eRowIdx missing) runs a fused kernel 
+//		when the cpu has crc32c, each group checksummed in registers. other
+//		cases recover a cache tile, then checksum the tile, outputs included,
+//		from cache: the kernels are run without streaming stores. single 
+//		threaded.
+//*****************************************************************************
+int  CRaid6::recover_crc(T** block, size_t numBytes, int numDisk, int missingDisk1, int missingDisk2, unsigned* crc) {
+	int result = check_input(block, numBytes, numDisk, missingDisk1, missingDisk2);
+	if(errOK!=result) return result;
+	if(!crc) return errNullBlockPointer;
+
+	T* b[eLimitDiskNum+1];
+	unsigned c[eLimitDiskNum+1];
+	for(int i=numDisk-1; i>=0; --i) {
+		b[i] = block[i];
+		c[i] = ~crc[i];
+	}
+	if(missingDisk1 > missingDisk2) {
+		int tmp = missingDisk1;
+		missingDisk1 = missingDisk2;
+		missingDisk2 = tmp;
+	}
+	size_t numUnits = numBytes/sizeof(T);
+	R6CrcFnType fused = msEncodeCrcFnSet && numDisk<=eImpDiskNum? msEncodeCrcFnSet[mPrimeIdx].fn[numDisk-3] : 0;
+	if(fused && eDiaIdx==missingDisk1 && eRowIdx==missingDisk2) {
+		result = fused(b, numUnits, c);
+	}
+	else {
+		SKernel kernel = { get_recover_fn(numDisk, missingDisk1, missingDisk2),
+			get_loop_fn(), numDisk, missingDisk1, missingDisk2, 0, get_run_flags(numBytes, numDisk, 1) };
+		//the chunk is still in cache for the checksum
+		size_t chunk = get_tile_units(numDisk);
+		if(!chunk) chunk = raid6_config_tag::eDefTileBytes/sizeof(T)/numDisk/(mPrime-1)*(mPrime-1);
+		if(!chunk) chunk = mPrime-1;
+		for(size_t off=0; off<numUnits && errOK==result; off+=chunk) {
+			size_t n = numUnits-off<chunk? numUnits-off : chunk;
+			for(int i=numDisk-1; i>=0; --i) {
+				b[i] = block[i] + off;
+			}
+			if(numDisk==3) {
+				recover_3disk(b, n*sizeof(T), missingDisk1, missingDisk2);
+			}
+			else {
+				result = kernel.run_tile(b, n);
+			}
+			msCrcBlocksFn(b, n, numDisk, c);
+		}
+	}
+	if(errOK==result) {
+		for(int i=numDisk-1; i>=0; --i) {
+			crc[i] = ~c[i];
+		}
+	}
+	return result;
+}
+
+//crc32c of a buffer, chained as zlib's crc32(): crc32c(crc32c(0, a), b) is the crc of a then b
+unsigned CRaid6::crc32c(unsigned crc, const void* data, size_t numBytes) {
+	std::call_once(gInitOnce, init_once);
+	const unsigned char* p = (const unsigned char*)data;
+	crc = ~crc;
+	if( msCrcBlocksFn && ( (size_t)p & (sizeof(T)-1) )==0 ) {
+		T* b = (T*)p;
+		msCrcBlocksFn(&b, numBytes/sizeof(T), 1, &crc);
+		p += numBytes/sizeof(T)*sizeof(T);
+		numBytes %= sizeof(T);
+	}
+	return ~crc_bytes( crc, p, numBytes );
+}
+
+}//end namspace raid6
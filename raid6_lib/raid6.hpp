@@ -13,6 +13,7 @@
 #ifndef _RAID6_HPP_INCLUDE_
 #define _RAID6_HPP_INCLUDE_
 
+#include <stddef.h>
 #include "raid6_config.hpp"
 
 namespace raid6{
@@ -20,11 +21,22 @@ namespace raid6{
 	//lib constances 
 	enum EnumLibConsts
 	{
-		P           = raid6_config_tag::ePrime, //the Prime
-		eImpDiskNum = raid6_config_tag::eSupportDiskNum, //max disk num supported in this implementation
+		P           = raid6_config_tag::ePrime, //the default Prime
+		eImpDiskNum = raid6_config_tag::eSupportDiskNum, //max disk num supported by the unrolled kernels
 		eDiaIdx     = 0,                        //diagonal parity index
 		eRowIdx     = 1,                        //row parity index
 		eMaxDiskNum = P+2,                      //max disk num limit supported by P
+		eLimitPrime   = 257,                    //the largest Prime compiled in
+		eLimitDiskNum = eLimitPrime+2,          //max disk num limit of all the Primes
+	};
+
+	//Primes compiled in, CRaid6::set_prime() picks one per array
+	enum EnumLibPrime
+	{
+		ePrime5       = 0,						//32 bytes align unit, up to 7 disks
+		ePrime17      = 1,						//128 bytes align unit, up to 19 disks
+		ePrime257     = 2,						//2048 bytes align unit, up to 259 disks
+		ePrimeNum     = 3,
 	};
 
 	//error code
@@ -37,12 +49,71 @@ namespace raid6{
 		errNullBlockPointer = 3,				//a data buffer pointer is NULL	
 		errBufferNotAligned = 4,				//data buffer not start at aligned address. should aligned with the raid6_config_tag::base_type
 		errSizeNotAligned   = 5,				//data length not aligned. should aligned with the base_type * (P-1)
+		errKernelNotSupported = 6,				//kernel variant not compiled in or not supported by the cpu
+		errInvalidUpdateMode  = 7,				//update mode not in EnumUpdateMode
+		errInvalidPrime       = 8,				//Prime not compiled in
+		errParityMismatch     = 9,				//verify() found parity not matching the data, or scrub() fixed it
+		errUncorrectable      = 10,				//scrub() found a group no single disk corruption explains
+		errQueueFull          = 11,				//CRaid6Async has queue depth jobs in flight, the job is not taken
+		errInvalidFamily      = 12,				//kernel family not in EnumLibFamily
+		errInvalidLayout      = 13,				//parity layout not in EnumLayout, or chunk size 0
+		errInvalidPrefetch    = 14,				//prefetch mode not in EnumLibPrefetch
+	};
+
+	//recover kernel variants, all produce the same on disk layout.
+	enum EnumLibKernel
+	{
+		eKernelScalar = 0,						//one base_type per operation, always available
+		eKernelSSE2   = 1,						//128bit lanes
+		eKernelAVX2   = 2,						//256bit lanes
+		eKernelAVX512 = 3,						//512bit lanes
+		eKernelNum    = 4,
+	};
+
+	//recover kernel families, both on every kernel variant, same on disk layout.
+	enum EnumLibFamily
+	{
+		eFamilyUnroll = 0,						//unrolled kernel of each (disk number, missing pair) up to eImpDiskNum disks, loop above
+		eFamilyLoop   = 1,						//one loop kernel of runtime disk number and missing pair, small code
+		eFamilyNum    = 2,
+	};
+
+	//how the simd kernels treat the memory, see CRaid6::set_prefetch()
+	enum EnumLibPrefetch
+	{
+		ePrefetchOff  = 0,						//plain loads and stores
+		ePrefetchAuto = 1,						//prefetch the inputs, stream the outputs not read back if the call is above the last level cache
+		ePrefetchOn   = 2,						//prefetch the inputs, stream the outputs not read back whatever the size
+		ePrefetchNum  = 3,
+	};
+
+	//how update() reads the new data
+	enum EnumUpdateMode
+	{
+		eUpdateNew    = 0,						//dataNewOrDiff is the new data, dataOld the data on disk
+		eUpdateDiff   = 1,						//dataNewOrDiff is old^new already, dataOld not used
+		eUpdateModeNum= 2,
 	};
 
 	//base type definition
 	typedef raid6_config_tag::base_type		T;
 	typedef T**&                            block_t;
-	typedef int ( *R6RecoverFnType )(T** block, int numBytes);
+	typedef int ( *R6RecoverFnType )(T** block, size_t numUnits);	//numUnits: base_type count of each block
+	typedef int ( *R6UpdateFnType )(T** block, size_t numUnits);	//block: diagonal, row, old data, new data or diff
+	typedef int ( *R6LoopRecoverFnType )(T** block, size_t numUnits, int numDisk, int miss1, int miss2);
+	typedef int ( *R6LoopUpdateFnType )(T** block, size_t numUnits, int dataIdx, int mode);
+	typedef int ( *R6VerifyFnType )(T** block, size_t numUnits, size_t* badUnit);	//return mismatch mask of the first bad group
+	typedef int ( *R6LoopVerifyFnType )(T** block, size_t numUnits, int numDisk, size_t* badUnit);
+	typedef int ( *R6LocateFnType )(T** block, int numDisk);	//the bad disk of one group, -1 if not one disk
+	typedef int ( *R6CrcFnType )(T** block, size_t numUnits, unsigned* crc);	//crc: running state of each disk
+	typedef void ( *R6CrcBlocksFnType )(T** block, size_t numUnits, int numDisk, unsigned* crc);
+	typedef int ( *R6StarRecoverFnType )(T** block, size_t numUnits, int numDisk, const int* miss, int numMiss);
+
+	//function tables of the unrolled kernels of one prime, constant, see CRaid6
+	struct SRaid6RecoverTable { R6RecoverFnType fn[eImpDiskNum-2][eImpDiskNum][eImpDiskNum]; };	//[numDisk-3][miss1][miss2]
+	struct SRaid6UpdateTable  { R6UpdateFnType  fn[eUpdateModeNum][eImpDiskNum]; };				//[mode][dataIdx]
+	struct SRaid6VerifyTable  { R6VerifyFnType  fn[eImpDiskNum-2]; };								//[numDisk-3]
+	struct SRaid6CrcTable     { R6CrcFnType     fn[eImpDiskNum-2]; };								//[numDisk-3]
 
 	//helper function
 	template <class DST_T, class SRC_T, int Align>
@@ -53,27 +124,160 @@ namespace raid6{
 		return (DST_T*)(void*) ( ( (long long)(void*)(ptr) + (Align-1) ) & ( ~(long long)(Align-1) ) );
 	}
 
-	//the generic wrapper raid6 class
+	class CRaid6Pool;
+
+	//one stripe of a recover_batch() call
+	struct SRaid6Stripe
+	{
+		T**		block;							//buffers on all disks, as recover()
+		size_t	numBytes;
+		int		numDisk;
+		int		missingDisk1;
+		int		missingDisk2;
+		int		result;							//out: what recover() would return for this stripe
+	};
+
+	//one (P-1)-row group verify() or scrub() found bad
+	struct SRaid6Mismatch
+	{
+		size_t	offset;							//byte offset of the group in each block
+		int		mask;							//bit eDiaIdx: diagonal parity mismatch, bit eRowIdx: row parity mismatch
+		int		disk;							//scrub(): the disk located and rewritten, -1 if none or by verify()
+	};
+
+	//a byte range of every member, whole (P-1)-row groups
+	struct SRaid6Range
+	{
+		size_t	offset;							//byte offset in each member
+		size_t	numBytes;
+	};
+
+	//one piece of a member's buffer, as struct iovec. any alignment and length
+	struct SRaid6Segment
+	{
+		void*	base;
+		size_t	numBytes;
+	};
+
+	//a member as a list of segments, in order
+	struct SRaid6SgList
+	{
+		const SRaid6Segment*	seg;
+		int						numSeg;
+	};
+
+	//scratch a call stages unaligned buffers and partial groups through, grown on demand, kept by the engine
+	struct SRaid6Scratch
+	{
+		T*		buf;
+		size_t	numUnits;
+	};
+
+	//the generic wrapper raid6 class, one thread calls an engine at a time
 	class CRaid6{
 	private:
-		//the recover function table:
-		//index meaning							[numDisk-3];	[miss1 index];		[miss2 index]	//miss1 <= miss2
-		//avaiable set:							[3~eImpDiskNum] [0~eImpDiskNum-1]	[0~eImpDiskNum-1] 
-		static R6RecoverFnType msRecoverFnSet	[eImpDiskNum-2]	[eImpDiskNum]		[eImpDiskNum]; 	
+		//the function tables of unrolled kernels are constant initialized, in read only data.
+		//recover:		[kernel][prime].fn	[numDisk-3]		[miss1 index]	[miss2 index]	//miss1 <= miss2
+		//avaiable set:	[0~eKernelNum-1][0~2]	[3~min(eImpDiskNum,P+2)] [0~numDisk-1] [0~numDisk-1] 
+		//a simd kernel table is all 0 for a prime it could not serve, the scalar one runs.
+		static const SRaid6RecoverTable* const msRecoverFnSet[eKernelNum];
+
+		//update:		[prime].fn	[mode]	[data index 2~min(eImpDiskNum,P+2)-1]
+		static const SRaid6UpdateTable msUpdateFnSet[ePrimeNum];
+
+		//verify:		[prime].fn	[numDisk-3]
+		static const SRaid6VerifyTable msVerifyFnSet[ePrimeNum];
 
-		static int msInitialized;				//whether the msRecoverFnSet initialized 	
+		//loop kernels, serve the disk numbers not in the tables above, and all of them in eFamilyLoop
+		//recover:		[kernel][prime], 0 for a prime the simd kernel could not serve, the scalar one runs.
+		static const R6LoopRecoverFnType* const msLoopRecoverFnSet[eKernelNum];
+		static const R6LoopUpdateFnType  msLoopUpdateFnSet	[ePrimeNum];
+		static const R6LoopVerifyFnType  msLoopVerifyFnSet	[ePrimeNum];
+		static const R6LocateFnType      msLocateFnSet		[ePrimeNum];
+
+		//STAR triple parity, the anti-diagonal parity after the data:	[prime]
+		static const R6StarRecoverFnType msStarRecoverFnSet[ePrimeNum];
+
+		//the cpu dependent state below is set once by init_once(), whatever thread constructs first.
+		//the fused encode and crc32c kernels [prime], index as msVerifyFnSet, 0 if the cpu has no crc32c
+		static const SRaid6CrcTable* msEncodeCrcFnSet;
+		static R6CrcBlocksFnType msCrcBlocksFn;	//crc32c of blocks in cache, hardware if the cpu has it
+		static const int msPrimes				[ePrimeNum];
+
+		static int msKernelMask;				//bit k set if kernel variant k is usable on this cpu
+		static int msBestKernel;				//the widest usable kernel variant
+		static size_t msAutoTileBytes;			//tile bytes found at init, see raid6_config_tag::eTileBytes
+		static size_t msAutoNtBytes;			//streaming threshold found at init, see raid6_config_tag::eNtBytes
+
+		int mKernel;							//kernel variant used by this engine
+		int mFamily;							//EnumLibFamily used by this engine
+		int mPrimeIdx;							//EnumLibPrime of this engine
+		int mPrime;								//the Prime of this engine
+		CRaid6Pool* mPool;						//worker threads owned by this engine, 0 if single threaded
+		int mNuma;								//workers pinned over the numa nodes, slices run on their memory's node
+		size_t mTileBytes;						//bytes of all disks per tile, 0 if not tiled
+		int mPrefetch;							//EnumLibPrefetch used by this engine
+		SRaid6Scratch mScratch;					//staging of recover(), recover_batch() and recover_sg()
 
 	public:
 		CRaid6();
 		~CRaid6();
 
 	public:
-		int check_input(T** block, int numBytes, int numDisk, int missingDisk1, int missingDisk2);
-		int recover(T** block, int numBytes, int numDisk, int missingDisk1, int missingDisk2);
-		//int update(T* parity, int numBytes, T* dataOld, T* dataNewOrDiff, int dataIdx, int mode);
+		int check_input(T** block, size_t numBytes, int numDisk, int missingDisk1, int missingDisk2);	//what the kernels take in place
+		int recover(T** block, size_t numBytes, int numDisk, int missingDisk1, int missingDisk2);
+		int recover_to(const T* const* block, size_t numBytes, int numDisk, int missingDisk1, int missingDisk2, T* out1, T* out2);
+		int recover_batch(SRaid6Stripe* stripes, int numStripe);
+		int update(T** parity, size_t numBytes, T* dataOld, T* dataNewOrDiff, int dataIdx, int mode);
+		int verify(T** block, size_t numBytes, int numDisk, SRaid6Mismatch* bad, int maxBad, int* numBad);
+		int scrub(T** block, size_t numBytes, int numDisk, SRaid6Mismatch* bad, int maxBad, int* numBad);
+		int get_range(int numDisk, int missingDisk1, int missingDisk2, size_t offset, size_t length, 
+			SRaid6Range* range, unsigned char* needDisk) const;
+		int recover_range(T** block, size_t numBytes, int numDisk, int missingDisk1, int missingDisk2, size_t offset, size_t length);
+		int recover_crc(T** block, size_t numBytes, int numDisk, int missingDisk1, int missingDisk2, unsigned* crc);
+		int recover_sg(const SRaid6SgList* disk, size_t numBytes, int numDisk, int missingDisk1, int missingDisk2);
+		int recover_star(T** block, size_t numBytes, int numDisk, int missingDisk1, int missingDisk2, int missingDisk3);
+
+		static unsigned crc32c(unsigned crc, const void* data, size_t numBytes);	//crc 0 to start
+
+		int set_kernel(int kernel);				//force a kernel variant, errKernelNotSupported if not usable
+		int get_kernel() const;					//the kernel variant in use
+		int is_kernel_supported(int kernel) const;
+
+		int set_family(int family);				//eFamilyUnroll or eFamilyLoop, raid6_config_tag::eDefFamily by default
+		int get_family() const;
+
+		int set_thread_num(int numThread);		//worker threads used by recover, 0 or 1 runs on the calling thread
+		int get_thread_num() const;
+		int set_numa(int numa);					//1 to pin the workers over the numa nodes and run each slice on its memory's node, 0 by default
+		int get_numa() const;
+
+		int set_prime(int prime);				//5, 17 or 257, errInvalidPrime if not compiled in. P by default
+		int get_prime() const;
+		int get_max_disk_num() const;			//prime+2
+		int get_star_max_disk_num() const;		//prime+3, with the anti-diagonal parity
+		size_t get_align_bytes() const;			//numBytes should be multiple of base_type*(prime-1)
+		size_t get_dia_bytes(size_t numBytes) const;	//diagonal parity bytes of numBytes data, the last group whole
+
+		int set_tile_bytes(size_t tileBytes);	//cache tile of all disks used by recover, 0 not tiled
+		size_t get_tile_bytes() const;
+
+		int set_prefetch(int prefetch);			//EnumLibPrefetch, raid6_config_tag::eDoPrefetch by default
+		int get_prefetch() const;
 
 	private:
 		int init();
+		static void init_once();
+		R6RecoverFnType get_recover_fn(int numDisk, int missingDisk1, int missingDisk2) const;	//0 if loop kernel
+		R6LoopRecoverFnType get_loop_fn() const;
+		size_t get_tile_units(int numDisk) const;
+		int get_run_flags(size_t numBytes, int numDisk, int readBack) const;
+		int check_shape(T** block, size_t numBytes, int numDisk, int missingDisk1, int missingDisk2) const;
+		int is_in_place(T** block, int numDisk, int missingDisk1, int missingDisk2) const;
+		int scan(T** block, size_t numBytes, int numDisk, SRaid6Mismatch* bad, int maxBad, int* numBad, int repair);
+
+		CRaid6(const CRaid6&);
+		CRaid6& operator=(const CRaid6&);
 
 	};//end CRaid6
 
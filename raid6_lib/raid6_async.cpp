@@ -0,0 +1,186 @@
+/***
+*raid6_async.cpp - asynchronous raid6 engine
+*
+*       Copyright (c) Bingle	All rights reserved.
+*
+*Purpose:
+*       This file contains the implementation of the asynchronous engine.
+*
+*Author:
+*		Bingle(BinaryBB@hotmail.com)
+****/
+
+#include "raid6_async.hpp"
+
+namespace raid6{
+
+//the engine whose worker this thread is, 0 on other threads
+static thread_local const CRaid6Async* gWorkerOf = 0;
+
+CRaid6Async::CRaid6Async(int numThread, int queueDepth, int fullMode, int prime)
+	: mDepth(queueDepth<1? 1 : queueDepth), mFullMode(fullMode), mInFlight(0), mRunToQueue(0), mStop(false)
+{
+	if(numThread<1) numThread = 1;
+	for(int i=0; i<numThread; ++i) {
+		mEngine.push_back( new CRaid6 );
+		if( errOK!=mEngine[i]->set_prime(prime) ) mEngine[i]->set_prime(P);
+	}
+	for(int i=0; i<numThread; ++i) {
+		mWorkers.push_back( std::thread(&CRaid6Async::worker_main, this, i) );
+	}
+}
+
+CRaid6Async::~CRaid6Async() {
+	{
+		std::lock_guard<std::mutex> lk(mLock);
+		mStop = true;
+	}
+	mWork.notify_all();
+	mSpace.notify_all();
+	for(size_t i=0; i<mWorkers.size(); ++i) {
+		mWorkers[i].join();
+	}
+	for(size_t i=0; i<mEngine.size(); ++i) {
+		delete mEngine[i];
+	}
+}
+
+int CRaid6Async::submit(SRaid6Job* job) {
+	SEntry entry = { job, 0, 0, 0 };
+	return enqueue(entry);
+}
+
+int CRaid6Async::submit(SRaid6Job* job, R6AsyncDoneFnType done, void* arg) {
+	if(!done) return errFAIL;
+	SEntry entry = { job, done, arg, 0 };
+	return enqueue(entry);
+}
+
+std::future<int> CRaid6Async::submit_future(SRaid6Job* job) {
+	std::promise<int>* promise = new std::promise<int>;
+	std::future<int> f = promise->get_future();
+	SEntry entry = { job, 0, 0, promise };
+	int result = enqueue(entry);
+	if(errOK!=result) {
+		//not taken, the future is ready with why
+		promise->set_value(result);
+		delete promise;
+	}
+	return f;
+}
+
+int CRaid6Async::enqueue(const SEntry& entry) {
+	if(!entry.job) return errNullBlockPointer;
+	if(entry.job->op<0 || entry.job->op>=eAsyncOpNum) return errFAIL;
+	std::unique_lock<std::mutex> lk(mLock);
+	while(!mStop && mInFlight>=mDepth) {
+		//a callback waiting for a slot holds up its worker, with all of them waiting no job runs to free one
+		if(eAsyncReject==mFullMode || this==gWorkerOf) return errQueueFull;
+		mSpace.wait(lk);
+	}
+	if(mStop) return errFAIL;
+	++mInFlight;
+	if(!entry.done && !entry.promise) ++mRunToQueue;
+	mQueue.push_back(entry);
+	lk.unlock();
+	mWork.notify_one();
+	return errOK;
+}
+
+int CRaid6Async::poll(SRaid6Job** jobs, int maxJobs) {
+	if(!jobs) return 0;
+	std::lock_guard<std::mutex> lk(mLock);
+	int n = 0;
+	for(; n<maxJobs && !mCompleted.empty(); ++n) {
+		jobs[n] = mCompleted.front();
+		mCompleted.pop_front();
+		--mInFlight;
+	}
+	if(n>0) mSpace.notify_all();
+	return n;
+}
+
+int CRaid6Async::wait(SRaid6Job** jobs, int maxJobs) {
+	if(!jobs || maxJobs<=0) return 0;
+	{
+		std::unique_lock<std::mutex> lk(mLock);
+		while( mCompleted.empty() && mRunToQueue>0 ) {
+			mDone.wait(lk);
+		}
+	}
+	return poll(jobs, maxJobs);
+}
+
+int CRaid6Async::set_kernel(int kernel) {
+	for(size_t i=0; i<mEngine.size(); ++i) {
+		int result = mEngine[i]->set_kernel(kernel);
+		if(errOK!=result) return result;
+	}
+	return errOK;
+}
+
+int CRaid6Async::get_thread_num() const {
+	return (int)mEngine.size();
+}
+
+int CRaid6Async::get_depth() const {
+	return mDepth;
+}
+
+int CRaid6Async::get_in_flight() {
+	std::lock_guard<std::mutex> lk(mLock);
+	return mInFlight;
+}
+
+void CRaid6Async::worker_main(int self) {
+	CRaid6& r6 = *mEngine[self];
+	gWorkerOf = this;
+	for(;;) {
+		SEntry entry;
+		{
+			std::unique_lock<std::mutex> lk(mLock);
+			while(!mStop && mQueue.empty()) {
+				mWork.wait(lk);
+			}
+			//on stop the queue is still run dry, the jobs submitted are owed a completion
+			if(mQueue.empty()) break;
+			entry = mQueue.front();
+			mQueue.pop_front();
+		}
+
+		SRaid6Job* job = entry.job;
+		switch(job->op) {
+		case eAsyncRecover:
+			job->result = r6.recover(job->block, job->numBytes, job->numDisk, job->missingDisk1, job->missingDisk2);
+			break;
+		case eAsyncEncode:
+			job->result = r6.recover(job->block, job->numBytes, job->numDisk, eDiaIdx, eRowIdx);
+			break;
+		case eAsyncVerify:
+			job->result = r6.verify(job->block, job->numBytes, job->numDisk, job->bad, job->maxBad, &job->numBad);
+			break;
+		}
+
+		//out of flight before the caller hears of it, a callback could submit the next job at once
+		std::unique_lock<std::mutex> lk(mLock);
+		if(!entry.done && !entry.promise) {
+			--mRunToQueue;
+			mCompleted.push_back(job);
+			lk.unlock();
+			mDone.notify_all();
+			continue;
+		}
+		--mInFlight;
+		lk.unlock();
+		mSpace.notify_one();
+		if(entry.done) {
+			entry.done(entry.arg, job);
+		}
+		else {
+			entry.promise->set_value(job->result);
+			delete entry.promise;
+		}
+	}
+}
+
+}//end namespace raid6
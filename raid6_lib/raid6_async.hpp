@@ -0,0 +1,123 @@
+/***
+*raid6_async.hpp - asynchronous raid6 engine
+*
+*       Copyright (c) Bingle	All rights reserved.
+*
+*Purpose:
+*       This file contains the submit/complete interface for callers that could
+*       not block on a recover, e.g. event loop I/O threads. Jobs run on worker
+*       threads, each with its own engine, and complete through a future, a 
+*       callback or the completion queue.
+*
+*Author:
+*		Bingle(BinaryBB@hotmail.com)
+****/
+
+#ifndef _RAID6_ASYNC_HPP_INCLUDE_
+#define _RAID6_ASYNC_HPP_INCLUDE_
+
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include "raid6.hpp"
+
+namespace raid6{
+
+	//what a job runs
+	enum EnumAsyncOp
+	{
+		eAsyncRecover = 0,						//recover(), missing disks as given
+		eAsyncEncode  = 1,						//recover() of both parities, missing disks not used
+		eAsyncVerify  = 2,						//verify(), bad/maxBad in, numBad out
+		eAsyncOpNum   = 3,
+	};
+
+	//what submit does when queue depth jobs are in flight
+	enum EnumAsyncFull
+	{
+		eAsyncBlock   = 0,						//wait until one completes, errQueueFull from a callback of the same engine
+		eAsyncReject  = 1,						//return errQueueFull at once
+	};
+
+	//one job, the caller keeps it and its buffers alive until it completes
+	struct SRaid6Job
+	{
+		int				op;						//EnumAsyncOp
+		T**				block;					//as recover()
+		size_t			numBytes;
+		int				numDisk;
+		int				missingDisk1;
+		int				missingDisk2;
+		SRaid6Mismatch*	bad;					//eAsyncVerify only, may be 0
+		int				maxBad;
+		int				numBad;					//out: eAsyncVerify only
+		void*			userData;				//not touched
+		int				result;					//out: what the call returned
+	};
+
+	//called on a worker thread when the job completes, should not block long.
+	//a submit from it to the same engine never waits, errQueueFull if the queue is full
+	typedef void ( *R6AsyncDoneFnType )(void* arg, SRaid6Job* job);
+
+	//*****************************************************************************
+	// class CRaid6Async
+	// a fixed set of workers, each owns a CRaid6, takes jobs from one queue. a
+	// job is in flight from submit until its callback returns, its future is
+	// ready, or poll()/wait() hands it back. at most queueDepth jobs are in 
+	// flight, submit then blocks or rejects as fullMode says.
+	//*****************************************************************************
+	class CRaid6Async{
+	private:
+		struct SEntry {
+			SRaid6Job*			job;
+			R6AsyncDoneFnType	done;			//callback, or
+			void*				arg;
+			std::promise<int>*	promise;		//future, or the completion queue if both 0
+		};
+
+		std::vector<CRaid6*>		mEngine;	//one per worker
+		std::vector<std::thread>	mWorkers;
+		std::deque<SEntry>			mQueue;		//submitted, not started
+		std::deque<SRaid6Job*>		mCompleted;	//completed, not polled
+		std::mutex					mLock;
+		std::condition_variable		mWork;		//signaled when queued or stopping
+		std::condition_variable		mSpace;		//signaled when a job leaves flight
+		std::condition_variable		mDone;		//signaled when a queue mode job completes
+		int							mDepth;
+		int							mFullMode;
+		int							mInFlight;
+		int							mRunToQueue;	//queue mode jobs not completed yet
+		bool						mStop;
+
+	public:
+		explicit CRaid6Async(int numThread = 1, int queueDepth = raid6_config_tag::eAsyncDepth, 
+			int fullMode = eAsyncBlock, int prime = P);
+		~CRaid6Async();						//the jobs submitted are run before it returns
+
+	public:
+		int submit(SRaid6Job* job);											//completes to poll()/wait()
+		int submit(SRaid6Job* job, R6AsyncDoneFnType done, void* arg);		//completes to the callback
+		std::future<int> submit_future(SRaid6Job* job);						//the future holds job->result
+
+		int poll(SRaid6Job** jobs, int maxJobs);	//completed jobs, 0 if none, never blocks
+		int wait(SRaid6Job** jobs, int maxJobs);	//as poll(), blocks until one completes or none left for it
+
+		int set_kernel(int kernel);				//of all workers, call while nothing in flight
+		int get_thread_num() const;
+		int get_depth() const;
+		int get_in_flight();
+
+	private:
+		int enqueue(const SEntry& entry);
+		void worker_main(int self);
+
+		CRaid6Async(const CRaid6Async&);
+		CRaid6Async& operator=(const CRaid6Async&);
+	};//end CRaid6Async
+
+}//end namespace
+
+#endif//_RAID6_ASYNC_HPP_INCLUDE_
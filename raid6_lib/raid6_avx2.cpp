@@ -0,0 +1,102 @@
+/***
+*raid6_avx2.cpp - avx2 kernels for raid6 library
+*
+*       Copyright (c) Bingle	All rights reserved.
+*
+*Purpose:
+*       This file instantiates CVectorRaid6 and the P+Q CGfRaid6 on 256bit lanes.
+*       Compile it with avx2 enabled, CRaid6 only picks these kernels if the cpu supports avx2.
+*
+*Author:
+*		Bingle(BinaryBB@hotmail.com)
+****/
+
+#include "raid6_engine.hpp"
+#include "raid6_gf.hpp"
+
+#ifdef LIB_SIMD_AVX2_ENABLED
+#include <immintrin.h>
+
+namespace raid6{
+namespace {
+
+//4 rows of a group per lane
+template<int _P>
+struct lane_avx2 {
+	typedef __m256i type;
+	enum { eWidth = 4, ePrime = _P };
+	template<int _ND> class engine { public: typedef CVectorRaid6<_ND, lane_avx2> type; };
+
+	static inline type zero()						{ return _mm256_setzero_si256(); }
+	static inline type set1(T t)					{ return _mm256_set1_epi64x(t); }
+	static inline type vxor(type a, type b)			{ return _mm256_xor_si256(a, b); }
+	static inline type load(const T* p)				{ return _mm256_loadu_si256( (const __m256i*)p ); }
+	static inline void store(T* p, type v)			{ _mm256_storeu_si256( (__m256i*)p, v ); }
+	static inline void stream(T* p, type v)			{ _mm256_stream_si256( (__m256i*)p, v ); }
+	static inline void fence()						{ _mm_sfence(); }
+	static inline void prefetch(const T* p)			{ _mm_prefetch( (const char*)p, _MM_HINT_T0 ); }
+
+	//lanes before the group start come from the group end, masked loads never touch the rest
+	template<int _K, int _V>
+	static inline type rot(const T* p) {
+		enum { eLo = _V*eWidth - _K };
+		if( eLo>=0 ) return load( p + eLo );
+		type v = _mm256_maskload_epi64( (const long long*)(p + eLo), 
+			_mm256_set_epi64x( -(eLo+3>=0), -(eLo+2>=0), -(eLo+1>=0), 0 ) );
+		if( eLo<=-2 ) {
+			v = _mm256_or_si256( v, _mm256_maskload_epi64( (const long long*)(p + eLo + ePrime),
+				_mm256_set_epi64x( -(eLo+3<=-2), -(eLo+2<=-2), -(eLo+1<=-2), -1 ) ) );
+		}
+		return v;
+	}
+};
+
+//32 bytes of a P+Q stripe per lane, the constant multiply by byte shuffles of the 
+//low and high nibble tables
+struct gf_lane_avx2 {
+	typedef __m256i type;
+	enum { eBytes = 32 };
+
+	static inline type zero()							{ return _mm256_setzero_si256(); }
+	static inline type vxor(type a, type b)				{ return _mm256_xor_si256(a, b); }
+	static inline type load(const unsigned char* p)		{ return _mm256_loadu_si256( (const __m256i*)p ); }
+	static inline void store(unsigned char* p, type v)	{ _mm256_storeu_si256( (__m256i*)p, v ); }
+	static inline type mul2(type v) {
+		return _mm256_xor_si256( _mm256_add_epi8(v, v), 
+			_mm256_and_si256( _mm256_cmpgt_epi8(_mm256_setzero_si256(), v), _mm256_set1_epi8(0x1d) ) );
+	}
+	static inline type mulc(type v, const unsigned char* nib) {
+		type lo = _mm256_broadcastsi128_si256( _mm_loadu_si128( (const __m128i*)nib ) );
+		type hi = _mm256_broadcastsi128_si256( _mm_loadu_si128( (const __m128i*)(nib+16) ) );
+		type m  = _mm256_set1_epi8(0x0f);
+		return _mm256_xor_si256( _mm256_shuffle_epi8( lo, _mm256_and_si256(v, m) ),
+			_mm256_shuffle_epi8( hi, _mm256_and_si256( _mm256_srli_epi16(v, 4), m ) ) );
+	}
+};
+
+}//end anonymous namespace
+
+//constant initialized, the table of a prime the lanes could not serve is all 0
+const SRaid6RecoverTable gRecoverFnSetAVX2[ePrimeNum] = {
+	CRecoverTable< lane_avx2<5> >::table(),
+	CRecoverTable< lane_avx2<17> >::table(),
+	CRecoverTable< lane_avx2<257> >::table(),
+};
+const R6LoopRecoverFnType gLoopRecoverFnSetAVX2[ePrimeNum] = {
+	CLoopVectorTable< lane_avx2<5> >::fn(),
+	CLoopVectorTable< lane_avx2<17> >::fn(),
+	CLoopVectorTable< lane_avx2<257> >::fn(),
+};
+const R6GfRecoverFnType gGfRecoverFnAVX2 = CGfRaid6<gf_lane_avx2>::recover;
+
+}//end namespace raid6
+
+#else //LIB_SIMD_AVX2_ENABLED
+
+namespace raid6{
+const SRaid6RecoverTable gRecoverFnSetAVX2[ePrimeNum] = {};
+const R6LoopRecoverFnType gLoopRecoverFnSetAVX2[ePrimeNum] = {};
+const R6GfRecoverFnType gGfRecoverFnAVX2 = 0;
+}//end namespace raid6
+
+#endif//LIB_SIMD_AVX2_ENABLED
@@ -0,0 +1,75 @@
+/***
+*raid6_avx512.cpp - avx512 kernels for raid6 library
+*
+*       Copyright (c) Bingle	All rights reserved.
+*
+*Purpose:
+*       This file instantiates CVectorRaid6 on 512bit lanes.
+*       Compile it with avx512f enabled, CRaid6 only picks these kernels if the cpu supports avx512.
+*
+*Author:
+*		Bingle(BinaryBB@hotmail.com)
+****/
+
+#include "raid6_engine.hpp"
+
+#ifdef LIB_SIMD_AVX512_ENABLED
+#include <immintrin.h>
+
+namespace raid6{
+namespace {
+
+//8 rows of a group per lane
+template<int _P>
+struct lane_avx512 {
+	typedef __m512i type;
+	enum { eWidth = 8, ePrime = _P };
+	template<int _ND> class engine { public: typedef CVectorRaid6<_ND, lane_avx512> type; };
+
+	static inline type zero()						{ return _mm512_setzero_si512(); }
+	static inline type set1(T t)					{ return _mm512_set1_epi64(t); }
+	static inline type vxor(type a, type b)			{ return _mm512_xor_si512(a, b); }
+	static inline type load(const T* p)				{ return _mm512_loadu_si512( (const void*)p ); }
+	static inline void store(T* p, type v)			{ _mm512_storeu_si512( (void*)p, v ); }
+	static inline void stream(T* p, type v)			{ _mm512_stream_si512( (__m512i*)p, v ); }
+	static inline void fence()						{ _mm_sfence(); }
+	static inline void prefetch(const T* p)			{ _mm_prefetch( (const char*)p, _MM_HINT_T0 ); }
+
+	//lanes before the group start come from the group end, masked loads never touch the rest
+	template<int _K, int _V>
+	static inline type rot(const T* p) {
+		enum { eLo = _V*eWidth - _K };
+		if( eLo>=0 ) return load( p + eLo );
+		const int lo = -eLo;				//lanes below lo wrap, lane lo-1 is the row P-1
+		__mmask8 m1 = (__mmask8)( lo>=eWidth ? 0 : ( 0xff << (lo & 7) ) );
+		__mmask8 m2 = (__mmask8)( lo-1>=eWidth ? 0xff : ( (1 << ((lo-1) & 7)) - 1 ) );
+		type v = _mm512_maskz_loadu_epi64( m1, (const void*)(p + eLo) );
+		if( m2 ) v = _mm512_mask_loadu_epi64( v, m2, (const void*)(p + eLo + ePrime) );
+		return v;
+	}
+};
+
+}//end anonymous namespace
+
+//constant initialized, the table of a prime the lanes could not serve is all 0
+const SRaid6RecoverTable gRecoverFnSetAVX512[ePrimeNum] = {
+	CRecoverTable< lane_avx512<5> >::table(),
+	CRecoverTable< lane_avx512<17> >::table(),
+	CRecoverTable< lane_avx512<257> >::table(),
+};
+const R6LoopRecoverFnType gLoopRecoverFnSetAVX512[ePrimeNum] = {
+	CLoopVectorTable< lane_avx512<5> >::fn(),
+	CLoopVectorTable< lane_avx512<17> >::fn(),
+	CLoopVectorTable< lane_avx512<257> >::fn(),
+};
+
+}//end namespace raid6
+
+#else //LIB_SIMD_AVX512_ENABLED
+
+namespace raid6{
+const SRaid6RecoverTable gRecoverFnSetAVX512[ePrimeNum] = {};
+const R6LoopRecoverFnType gLoopRecoverFnSetAVX512[ePrimeNum] = {};
+}//end namespace raid6
+
+#endif//LIB_SIMD_AVX512_ENABLED
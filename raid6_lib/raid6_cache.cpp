@@ -0,0 +1,282 @@
+/***
+*raid6_cache.cpp - write-back stripe cache for raid6 library
+*
+*       Copyright (c) Bingle	All rights reserved.
+*
+*Purpose:
+*       This file contains the implementation of the write-back stripe cache.
+*
+*Author:
+*		Bingle(BinaryBB@hotmail.com)
+****/
+
+#include <string.h>
+#include "raid6_cache.hpp"
+
+namespace raid6{
+
+CRaid6Cache::CRaid6Cache(CRaid6& engine, int numStripe)
+	: mR6(engine), mLayout(0), mIo(0), mIoArg(0), mNumStripe(numStripe<1? 1 : numStripe),
+	mNumData(0), mChunk(0), mClock(0)
+{
+	reset_stats();
+}
+
+CRaid6Cache::~CRaid6Cache() {
+	flush();
+}
+
+int CRaid6Cache::begin(const CRaid6Layout& layout, R6MemberIoFnType io, void* arg) {
+	int numMember = layout.get_num_member();
+	size_t chunk  = layout.get_chunk_bytes();
+	if(!io) return errFAIL;
+	if(numMember<3 || numMember>mR6.get_max_disk_num() )	return errInvalidDiskNum;
+	if( chunk%mR6.get_align_bytes()!=0 )	return errSizeNotAligned;
+	int result = flush();
+	if(errOK!=result) return result;
+
+	mLayout  = &layout;
+	mIo      = io;
+	mIoArg   = arg;
+	mNumData = numMember-2;
+	mChunk   = chunk;
+	mClock   = 0;
+	size_t chunks = (size_t)mNumStripe*mNumData;
+	mEntry.assign(mNumStripe, SEntry());
+	mLo.assign(chunks, 0);
+	mHi.assign(chunks, 0);
+	mData.resize( chunks*(mChunk/sizeof(T)) );
+	mStage.resize( 3*(mChunk/sizeof(T)) );
+	reset_stats();
+	return errOK;
+}
+
+int CRaid6Cache::write(unsigned long long offset, const void* data, size_t numBytes) {
+	if(!mLayout) return errFAIL;
+	if(!data && numBytes) return errNullBlockPointer;
+	const char* src = (const char*)data;
+	int result = errOK;
+	while(numBytes && errOK==result) {
+		SRaid6Extent e;
+		mLayout->map(offset, numBytes, &e, 1, 0);
+		int entry = find(e.stripe);
+		if(entry>=0) {
+			++mStats.writeHits;
+		}
+		else {
+			++mStats.writeMisses;
+			result = take(e.stripe, &entry);
+			if(errOK!=result) break;
+		}
+		mEntry[entry].lastUse = ++mClock;
+		size_t k = (size_t)entry*mNumData + e.blockIdx-2;
+		char* c = (char*)chunk_of(entry, e.blockIdx-2);
+		size_t lo = e.offset, hi = e.offset+e.numBytes;
+		if(mLo[k]==mHi[k]) {
+			mLo[k] = lo;
+			mHi[k] = hi;
+		}
+		else {
+			//a gap to the range in cache is read in, the range stays one piece
+			if(lo>mHi[k]) {
+				result = io(0, e.stripe, e.blockIdx, mHi[k], c + mHi[k], lo-mHi[k]);
+			}
+			else if(hi<mLo[k]) {
+				result = io(0, e.stripe, e.blockIdx, hi, c + hi, mLo[k]-hi);
+			}
+			if(errOK!=result) break;
+			if(lo<mLo[k]) mLo[k] = lo;
+			if(hi>mHi[k]) mHi[k] = hi;
+		}
+		memcpy(c + e.offset, src, e.numBytes);
+		mStats.userBytes += e.numBytes;
+		src      += e.numBytes;
+		offset   += e.numBytes;
+		numBytes -= e.numBytes;
+	}
+	return result;
+}
+
+int CRaid6Cache::read(unsigned long long offset, void* data, size_t numBytes) {
+	if(!mLayout) return errFAIL;
+	if(!data && numBytes) return errNullBlockPointer;
+	char* dst = (char*)data;
+	int result = errOK;
+	while(numBytes && errOK==result) {
+		SRaid6Extent e;
+		mLayout->map(offset, numBytes, &e, 1, 0);
+		int entry = find(e.stripe);
+		size_t lo = 0, hi = 0;
+		if(entry>=0) {
+			size_t k = (size_t)entry*mNumData + e.blockIdx-2;
+			lo = mLo[k] > e.offset? mLo[k] : e.offset;
+			hi = mHi[k] < e.offset+e.numBytes? mHi[k] : e.offset+e.numBytes;
+		}
+		if(lo<hi && lo==e.offset && hi==e.offset+e.numBytes) {
+			++mStats.readHits;
+		}
+		else {
+			++mStats.readMisses;
+			result = mIo(mIoArg, 0, e.member, e.memberOffset, dst, e.numBytes);
+		}
+		//the cached part over what the member has
+		if(lo<hi) {
+			memcpy(dst + (lo-e.offset), (char*)chunk_of(entry, e.blockIdx-2) + lo, hi-lo);
+		}
+		dst      += e.numBytes;
+		offset   += e.numBytes;
+		numBytes -= e.numBytes;
+	}
+	return result;
+}
+
+int CRaid6Cache::flush() {
+	int result = errOK;
+	for(int i=0; i<(int)mEntry.size() && errOK==result; ++i) {
+		if(mEntry[i].used) result = write_back(i);
+	}
+	return result;
+}
+
+int CRaid6Cache::get_cached_num() const {
+	int n = 0;
+	for(size_t i=0; i<mEntry.size(); ++i) {
+		n += mEntry[i].used;
+	}
+	return n;
+}
+
+void CRaid6Cache::get_stats(SRaid6CacheStats* stats) const {
+	if(stats) *stats = mStats;
+}
+
+void CRaid6Cache::reset_stats() {
+	memset(&mStats, 0, sizeof(mStats));
+}
+
+int CRaid6Cache::find(unsigned long long stripe) const {
+	for(size_t i=0; i<mEntry.size(); ++i) {
+		if(mEntry[i].used && mEntry[i].stripe==stripe) return (int)i;
+	}
+	return -1;
+}
+
+//a free entry for stripe, the least recently used one written back if none
+int CRaid6Cache::take(unsigned long long stripe, int* entry) {
+	int e = 0;
+	for(int i=0; i<(int)mEntry.size(); ++i) {
+		if(!mEntry[i].used) {
+			e = i;
+			break;
+		}
+		if(mEntry[i].lastUse<mEntry[e].lastUse) e = i;
+	}
+	if(mEntry[e].used) {
+		int result = write_back(e);
+		if(errOK!=result) return result;
+	}
+	for(int i=0; i<mNumData; ++i) {
+		mLo[(size_t)e*mNumData + i] = mHi[(size_t)e*mNumData + i] = 0;
+	}
+	mEntry[e].stripe = stripe;
+	mEntry[e].used   = 1;
+	*entry = e;
+	return errOK;
+}
+
+//*****************************************************************************
+//Function:
+//		write one stripe back and free its entry.
+//Comment:
+//		reconstruct-write reads the parts of the data chunks not in cache, one
+//		read for an empty chunk and one for each side of a partial one. read-
+//		modify-write reads the old data of each cached range, whole groups, and
+//		both parities over all of them. the fewer reads wins, reconstruct-write
+//		on a tie, with none it is the full stripe encode. only the cached
+//		ranges and the parities are written.
+//*****************************************************************************
+int CRaid6Cache::write_back(int entry) {
+	const size_t* lo = &mLo[ (size_t)entry*mNumData ];
+	const size_t* hi = &mHi[ (size_t)entry*mNumData ];
+	unsigned long long stripe = mEntry[entry].stripe;
+	size_t group = mR6.get_align_bytes();
+	int rcwReads = 0, rmwReads = 2, numDirty = 0;
+	size_t plo = mChunk, phi = 0;
+	for(int i=0; i<mNumData; ++i) {
+		if(lo[i]==hi[i]) {
+			++rcwReads;
+			continue;
+		}
+		++numDirty;
+		++rmwReads;
+		rcwReads += (lo[i]>0) + (hi[i]<mChunk);
+		if(lo[i]/group*group<plo) plo = lo[i]/group*group;
+		if( (hi[i]+group-1)/group*group>phi ) phi = (hi[i]+group-1)/group*group;
+	}
+	T* dia = &mStage[0];
+	T* row = dia + mChunk/sizeof(T);
+	T* old = row + mChunk/sizeof(T);
+	int result = errOK;
+	if(numDirty && rcwReads<=rmwReads) {
+		T* b[eLimitDiskNum+1];
+		b[eDiaIdx] = dia;
+		b[eRowIdx] = row;
+		for(int i=0; i<mNumData && errOK==result; ++i) {
+			char* c = (char*)chunk_of(entry, i);
+			b[i+2] = (T*)c;
+			if(lo[i]==hi[i]) {
+				result = io(0, stripe, i+2, 0, c, mChunk);
+				continue;
+			}
+			if(lo[i]>0) result = io(0, stripe, i+2, 0, c, lo[i]);
+			if(errOK==result && hi[i]<mChunk) result = io(0, stripe, i+2, hi[i], c + hi[i], mChunk-hi[i]);
+		}
+		if(errOK==result) result = mR6.recover(b, mChunk, mNumData+2, eDiaIdx, eRowIdx);
+		if(errOK==result) result = io(1, stripe, eDiaIdx, 0, dia, mChunk);
+		if(errOK==result) result = io(1, stripe, eRowIdx, 0, row, mChunk);
+		++mStats.flush[ rcwReads? eFlushRcw : eFlushFull ];
+	}
+	else if(numDirty) {
+		result = io(0, stripe, eDiaIdx, plo, (char*)dia + plo, phi-plo);
+		if(errOK==result) result = io(0, stripe, eRowIdx, plo, (char*)row + plo, phi-plo);
+		for(int i=0; i<mNumData && errOK==result; ++i) {
+			if(lo[i]==hi[i]) continue;
+			size_t glo = lo[i]/group*group, ghi = (hi[i]+group-1)/group*group;
+			char* c = (char*)chunk_of(entry, i);
+			result = io(0, stripe, i+2, glo, (char*)old + glo, ghi-glo);
+			if(errOK!=result) break;
+			//the group bytes out of the cached range are the old data
+			memcpy(c + glo, (char*)old + glo, lo[i]-glo);
+			memcpy(c + hi[i], (char*)old + hi[i], ghi-hi[i]);
+			T* parity[2] = { (T*)( (char*)dia + glo ), (T*)( (char*)row + glo ) };
+			result = mR6.update(parity, ghi-glo, (T*)( (char*)old + glo ), (T*)(c + glo), i+2, eUpdateNew);
+		}
+		if(errOK==result) result = io(1, stripe, eDiaIdx, plo, (char*)dia + plo, phi-plo);
+		if(errOK==result) result = io(1, stripe, eRowIdx, plo, (char*)row + plo, phi-plo);
+		++mStats.flush[eFlushRmw];
+	}
+	for(int i=0; i<mNumData && errOK==result; ++i) {
+		if(lo[i]<hi[i]) result = io(1, stripe, i+2, lo[i], (char*)chunk_of(entry, i) + lo[i], hi[i]-lo[i]);
+	}
+	if(errOK==result) mEntry[entry].used = 0;
+	return result;
+}
+
+//member io of a stripe's block, counted
+int CRaid6Cache::io(int write, unsigned long long stripe, int blockIdx, size_t offset, void* buf, size_t numBytes) {
+	if(write) {
+		++mStats.memberWrites;
+		mStats.memberWriteBytes += numBytes;
+	}
+	else {
+		++mStats.memberReads;
+		mStats.memberReadBytes += numBytes;
+	}
+	return mIo(mIoArg, write, mLayout->get_member(stripe, blockIdx), stripe*mChunk + offset, buf, numBytes);
+}
+
+T* CRaid6Cache::chunk_of(int entry, int dataIdx) {
+	return &mData[ ( (size_t)entry*mNumData + dataIdx )*(mChunk/sizeof(T)) ];
+}
+
+}//end namespace raid6
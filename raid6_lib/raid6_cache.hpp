@@ -0,0 +1,113 @@
+/***
+*raid6_cache.hpp - write-back stripe cache for raid6 library
+*
+*       Copyright (c) Bingle	All rights reserved.
+*
+*Purpose:
+*       This file contains the stripe cache, it holds the writes to a rotating
+*       parity array by stripe, merges the adjacent ones and writes each stripe
+*       back with the parity update that reads the fewest members.
+*
+*Author:
+*		Bingle(BinaryBB@hotmail.com)
+****/
+
+#ifndef _RAID6_CACHE_HPP_INCLUDE_
+#define _RAID6_CACHE_HPP_INCLUDE_
+
+#include <vector>
+#include "raid6.hpp"
+#include "raid6_layout.hpp"
+
+namespace raid6{
+
+	//reads or writes numBytes of member disk at memberOffset. return errOK, other value
+	//fails the cache call and is returned by it.
+	typedef int ( *R6MemberIoFnType )(void* arg, int write, int member, unsigned long long memberOffset, 
+		void* buf, size_t numBytes);
+
+	//how a stripe is written back
+	enum EnumCacheFlush
+	{
+		eFlushFull    = 0,						//all data in cache, parities encoded, no reads
+		eFlushRcw     = 1,						//reconstruct-write: the data not in cache read, parities encoded
+		eFlushRmw     = 2,						//read-modify-write: old data and parities read, update() by the delta
+		eFlushNum     = 3,
+	};
+
+	//counters since begin() or reset_stats(), the pieces are a call's parts in each stripe
+	struct SRaid6CacheStats
+	{
+		unsigned long long	writeHits;			//pieces written to a stripe in cache
+		unsigned long long	writeMisses;		//pieces that took a stripe in
+		unsigned long long	readHits;			//pieces read whole from cache
+		unsigned long long	readMisses;			//pieces read from the members
+		unsigned long long	flush[eFlushNum];	//stripes written back each way
+		unsigned long long	userBytes;			//bytes written by the caller
+		unsigned long long	memberReads;		//reads of the write path: gap fills and write back
+		unsigned long long	memberReadBytes;	//read amplification is memberReadBytes/userBytes
+		unsigned long long	memberWrites;
+		unsigned long long	memberWriteBytes;
+	};
+
+	//*****************************************************************************
+	// class CRaid6Cache
+	// write-back cache of up to numStripe stripes of a CRaid6Layout array. each 
+	// data chunk holds one byte range, a write next to or over it grows it, a 
+	// write with a gap fills the gap from the member first. a stripe is written
+	// back when flush() is called or its entry is the least recently used one
+	// needed for another stripe, by whichever of reconstruct-write and 
+	// read-modify-write reads fewer members. reads see the cached data. buffers
+	// are allocated by begin(), not by the calls after. not thread safe.
+	//*****************************************************************************
+	class CRaid6Cache{
+	private:
+		struct SEntry {
+			unsigned long long	stripe;
+			unsigned long long	lastUse;
+			int					used;
+		};
+
+		CRaid6&				mR6;
+		const CRaid6Layout*	mLayout;
+		R6MemberIoFnType	mIo;
+		void*				mIoArg;
+		int					mNumStripe;			//entries asked, taken by begin()
+		int					mNumData;			//data chunks of a stripe
+		size_t				mChunk;				//bytes of a chunk
+		unsigned long long	mClock;				//use count, for least recently used
+		std::vector<SEntry>	mEntry;
+		std::vector<size_t>	mLo;				//[entry*numData + chunk]: byte range in cache, lo==hi if none
+		std::vector<size_t>	mHi;
+		std::vector<T>		mData;				//[entry*numData + chunk] chunks
+		std::vector<T>		mStage;				//diagonal, row parity and old data chunks of a write back
+		SRaid6CacheStats	mStats;
+
+	public:
+		explicit CRaid6Cache(CRaid6& engine, int numStripe = raid6_config_tag::eCacheStripes);
+		~CRaid6Cache();						//flushes what is cached, errors are lost, call flush() first
+
+	public:
+		//start caching the array of layout, its chunk should be multiple of engine's get_align_bytes()
+		int begin(const CRaid6Layout& layout, R6MemberIoFnType io, void* arg);
+		int write(unsigned long long offset, const void* data, size_t numBytes);
+		int read(unsigned long long offset, void* data, size_t numBytes);
+		int flush();							//write back all stripes in cache
+		int get_cached_num() const;				//stripes in cache
+		void get_stats(SRaid6CacheStats* stats) const;
+		void reset_stats();
+
+	private:
+		int find(unsigned long long stripe) const;
+		int take(unsigned long long stripe, int* entry);
+		int write_back(int entry);
+		int io(int write, unsigned long long stripe, int blockIdx, size_t offset, void* buf, size_t numBytes);
+		T* chunk_of(int entry, int dataIdx);
+
+		CRaid6Cache(const CRaid6Cache&);
+		CRaid6Cache& operator=(const CRaid6Cache&);
+	};//end CRaid6Cache
+
+}//end namespace
+
+#endif//_RAID6_CACHE_HPP_INCLUDE_
@@ -23,11 +23,31 @@ namespace raid6{
 		typedef long long base_type;	//the base data unit type used by raid6 engine.
 
 		enum {
-			ePrime				= 17,	//the prime used by raid6 algorithm, should be 2^N+1.
+			ePrime				= 17,	//the default prime of CRaid6, one of the primes compiled in: 5, 17, 257.
 
-			eSupportDiskNum		= 8,	//maximun disk numbers the library could support when compiled out. 
-			//eSupportDiskNum should <=ePrime+2 !!!
-			eDoPrefetch			= 0,	//whether do prefetch instruction. not implemented in this version.
+			eSupportDiskNum		= 8,	//maximun disk numbers served by the unrolled kernels of each prime. 
+			//arrays up to prime+2 disks run the loop kernels. eSupportDiskNum should <=ePrime+2 !!!
+			eUnrollPrimeLimit	= 17,	//primes above this get only the loop kernels, unrolling (prime-1) rows costs too much code.
+			eDefFamily			= 0,	//kernel family CRaid6 starts with, 0 unrolled, 1 loop (see EnumLibFamily).
+			//the loop family is one kernel per prime and variant, pick it where the unrolled tables' code size hurts.
+			eDoPrefetch			= 1,	//EnumLibPrefetch CRaid6 starts with, 0 off, 1 auto, 2 on. CRaid6::set_prefetch() changes it at run time.
+			ePrefetchBytes		= 512,	//how far ahead of each input disk to prefetch.
+			eNtBytes			= 0,	//bytes of all disks of a call above which ePrefetchAuto streams the outputs.
+			//0 to take the last level cache size found at init, eDefNtBytes if it could not be found.
+			eDefNtBytes			= 8*1024*1024,
+
+			eParallelBytes		= 64*1024,	//bytes of each disk handled by one worker task when recover runs multi-threaded.
+			//keep eParallelBytes*numDisk around the L2 size, it is rounded down to base_type*(ePrime-1).
+
+			eStreamBytes		= 1024*1024,	//default bytes of each disk buffered by CRaid6Stream.
+
+			eAsyncDepth			= 64,	//default jobs CRaid6Async takes in before submit pushes back.
+
+			eCacheStripes		= 64,	//default stripes CRaid6Cache holds before it flushes the least recently used one.
+
+			eTileBytes			= 0,	//bytes of all disks a kernel works on before moving to the next tile.
+			//0 to take half the L2 size found at init, eDefTileBytes if it could not be found.
+			eDefTileBytes		= 256*1024,
 		};
 
 		//optimizing on different compiler
@@ -38,6 +58,17 @@ namespace raid6{
 		#define LIB_GCC4_1_OPTIMIZE_ENABLED
 		#endif
 		#endif
+
+		//simd kernel variants compiled in, CRaid6 picks the widest one the cpu supports at run time.
+		//they need a 64bit base_type and (ePrime-1) be multiple of the lane width.
+		#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+		#define LIB_SIMD_SSE2_ENABLED
+		#define LIB_SIMD_SSE42_ENABLED	//crc32c instruction of the checksum kernels
+		#ifndef WIN32	//vc10 has no avx2/avx512 intrinsics
+		#define LIB_SIMD_AVX2_ENABLED
+		#define LIB_SIMD_AVX512_ENABLED
+		#endif
+		#endif
 	};
 
 }//end namespace raid6
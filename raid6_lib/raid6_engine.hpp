@@ -0,0 +1,1569 @@
+/***
+*raid6_engine.hpp - the generic raid6 engine templates
+*
+*       Copyright (c) Bingle	All rights reserved.
+*
+*Purpose:
+*       This file contains the expression templates that generate the raid6 recover
+*       kernels. It is shared by raid6.cpp and the simd kernel units, each unit
+*       instantiates the engine with its own lane type and compile flags.
+*       Internal header, not for library users.
+*
+*Author:
+*		Bingle(BinaryBB@hotmail.com)
+****/
+
+#ifndef _RAID6_ENGINE_HPP_INCLUDE_
+#define _RAID6_ENGINE_HPP_INCLUDE_
+
+#include "raid6.hpp"
+
+namespace raid6{
+
+//how the kernels of the call running on this thread treat the memory, see CRaid6::set_prefetch().
+//CRaid6 sets it before it runs them, the kernels read it once per run.
+enum EnumRunFlag
+{
+	eRunPrefetch = 1,							//prefetch the inputs ePrefetchBytes ahead
+	eRunStream   = 2,							//stream the outputs not read back past the cache
+};
+extern thread_local int gRunFlags;
+
+#ifdef LIB_VC10_OPTIMIZE_ENABLED
+#define INLINE_FN_GEN1( ret_t ) public: static __forceinline ret_t gen(block_t b)
+#define INLINE_FN_GEN2( ret_t ) public: static __forceinline ret_t gen(block_t b, T& s) 
+#define INLINE_FN_VGEN( ret_t ) public: static __forceinline ret_t gen(block_t b, const lane_t& s) 
+#else
+#ifdef LIB_GCC4_1_OPTIMIZE_ENABLED 
+#define INLINE_FN_GEN1( ret_t ) public: static inline ret_t gen(block_t b) __attribute__((always_inline))
+#define INLINE_FN_GEN2( ret_t ) public: static inline ret_t gen(block_t b, T& s) __attribute__((always_inline))
+#define INLINE_FN_VGEN( ret_t ) public: static inline ret_t gen(block_t b, const lane_t& s) __attribute__((always_inline))
+#else // no optimize enabled
+#define INLINE_FN_GEN1( ret_t ) public: static ret_t gen(block_t b)
+#define INLINE_FN_GEN2( ret_t ) public: static ret_t gen(block_t b, T& s) 
+#define INLINE_FN_VGEN( ret_t ) public: static ret_t gen(block_t b, const lane_t& s) 
+#endif
+#endif
+
+//*****************************************************************************    
+//class CGenericRaid6: the generic raid6 class. 
+//Purpose:
+//  Target to generate raid6 operating code with generic programming technique
+//Template arguements naming :
+//  T:      the base data type.( ALIGN_TYPE, __int64 in this target implement)
+//  _P:     the Prime, 2^n+1, named P in the class
+//  _ND:    total disk number, include parity disks and data disks
+//  _IX:    X direction index, start from 0
+//  _IY:    Y direction index, start from 0
+//  _CX:    X direction count, start from 1
+//  _CY:    Y direction count, start from 1
+//  _Of:    Offset value
+//  _Ms:    missing disk index,(0 ~ _ND-1).
+//  _M1,_M2 first,second missing disk index,assert(_M1 <= _M2)!
+//Comment:
+//  assert diagonal index is 0, row parity index is 1,data disk index start form 2 to _ND-1.
+//*****************************************************************************
+template <int _ND, int _P = P>
+class CGenericRaid6{
+public:
+	enum { P = _P };
+private: //core expressions
+	//expression template for row indexer
+	template<int _Of, int _CX, int _IY>
+	class et_row_indexer {
+		INLINE_FN_GEN1( T ) {
+			return  b[_Of][_IY] ^ et_row_indexer<_Of+1, _CX-1, _IY>::gen(b) ;
+		}
+	};
+	template<int _Of,  int _IY>
+	class et_row_indexer<_Of, 1, _IY> {
+		INLINE_FN_GEN1( T ) {
+			return b[_Of][_IY];
+		}
+	};
+	template<int _Of,  int _IY>
+	class et_row_indexer<_Of, 0, _IY> {
+		INLINE_FN_GEN1( T ) {
+			return 0;
+		}
+	};
+	//expression template for diagonal indexer
+	template<int _Of, int _CX, int _IY>
+	class et_diagonal_indexer {
+		INLINE_FN_GEN1( T ) {
+			return b[_Of][_IY] ^ et_diagonal_indexer<_Of+1, _CX-1, _IY-1>::gen(b);
+		}
+	};
+	template<int _Of,  int _IY>
+	class et_diagonal_indexer<_Of, 1, _IY> {
+		INLINE_FN_GEN1( T ) {
+			return b[_Of][_IY];
+		}
+	};
+	template<int _Of, int _CX>
+	class et_diagonal_indexer<_Of, _CX, -1> {
+		INLINE_FN_GEN1( T ) {
+			return et_diagonal_indexer<_Of+1, _CX-1, P-2>::gen(b);
+		}
+	};
+	template<int _Of >
+	class et_diagonal_indexer<_Of, 1, -1> {
+		INLINE_FN_GEN1( T ) {
+			return 0;
+		}
+	};
+	template<int _Of,  int _IY>
+	class et_diagonal_indexer<_Of, 0, _IY> {
+		INLINE_FN_GEN1( T ) {
+			return 0;
+		}
+	};
+	template<int _Of >
+	class et_diagonal_indexer<_Of, 0, -1> {
+		INLINE_FN_GEN1( T ) {
+			return 0;
+		}
+	};
+	//expression template for increase pointer by (P-1). 
+	template <int _IX, int _Of, int _CX> 
+	class et_add_ptr {
+		INLINE_FN_GEN1( void ) {
+			b[_Of] += (P-1); et_add_ptr<_IX, _Of+1, _CX-1>::gen(b);
+		}
+	};
+	template <int _IX, int _Of> 
+	class et_add_ptr<_IX, _Of, 1> {
+		INLINE_FN_GEN1( void ) {
+			b[_IX] += (P-1); b[_Of] += (P-1);
+		}
+	};
+	//expression template for cal syndrome when missing two data
+	template<int _IY, int _IX1, int _IX2>
+	class et_syndrome{
+		INLINE_FN_GEN1( T ) {
+			//return b[eDiaIdx][_IY] ^ et_syndrome< _IY-1>::gen(b) ^ b[eRowIdx][_IY] ;
+			return et_syndrome<_IY-1, _IX1, _IX2>::gen(b) ^ b[_IX1][_IY] ^ b[_IX2][_IY] ;
+		}
+	};
+	template<int _IX1, int _IX2>
+	class et_syndrome<0, _IX1, _IX2>{
+		INLINE_FN_GEN1( T ) {
+			return b[_IX1][0] ^ b[_IX2][0] ;
+		}
+	}; //end core expressions
+	//expression template for row parity block
+	template<int _CX, int _IY>
+	class et_row_block {
+		INLINE_FN_GEN1( void ) {
+			et_row_block<_CX, _IY-1>::gen(b);
+			b[eRowIdx][_IY] = et_row_indexer<2, _CX, _IY>::gen(b) ;
+		}
+	};
+	template <int _CX>
+	class et_row_block<_CX, 0> {
+		INLINE_FN_GEN1( void ) {
+			b[eRowIdx][0] = et_row_indexer<2, _CX, 0>::gen(b) ;
+		}
+	};
+	//expression template for recover x from row line
+	template<int _IY, int _Ms>
+	class et_x_from_row{
+		INLINE_FN_GEN1( void ) {
+			b[_Ms][_IY] = et_row_indexer<eRowIdx, _Ms-eRowIdx, _IY>::gen(b)
+				^ et_row_indexer<_Ms+1, _ND-_Ms-1, _IY>::gen(b);
+		}
+	};
+	//expression template for recover x from row block
+	template<int _IY, int _Ms>
+	class et_x_from_row_block{
+		INLINE_FN_GEN1( void ) {
+			et_x_from_row_block<_IY-1, _Ms>::gen(b);
+			et_x_from_row<_IY, _Ms>::gen(b);
+		}
+	};
+	template<  int _Ms>
+	class et_x_from_row_block<0, _Ms> {
+		INLINE_FN_GEN1( void ) {
+			et_x_from_row<0, _Ms>::gen(b);
+		}
+	};
+	//expression template for diagonal block
+	template<int _CX, int _IY>
+	class et_diagonal_block {
+		INLINE_FN_GEN2( void ) {
+			et_diagonal_block<_CX, _IY-1>::gen(b, s);
+			b[eDiaIdx][_IY] = et_diagonal_indexer<2, _CX, _IY>::gen(b) ^ s;
+		}
+	};
+	template<int _CX >
+	class et_diagonal_block<_CX, 0> {
+		INLINE_FN_GEN2( void ) {
+			s = et_diagonal_indexer<2, _CX, -1>::gen(b);
+			b[eDiaIdx][0] = et_diagonal_indexer<2, _CX, 0>::gen(b) ^ s;
+		}
+	};
+	//expression template for recover x from diagonal line
+	template<int _IYMiss, int _IYDia, int _Ms>
+	class et_x_from_dia { // _IYMiss = _IYDia + _Ms-2
+		INLINE_FN_GEN2( void ) {
+			b[_Ms][_IYMiss] = b[eDiaIdx][_IYDia] ^ s
+				^ et_diagonal_indexer<2, _Ms-2, _IYDia>::gen(b)
+				^ et_diagonal_indexer<_Ms+1, _ND-_Ms-1, _IYMiss-1>::gen(b);
+		}
+	};
+	template<int _IYMiss, int _Ms>
+	class et_x_from_dia <_IYMiss, -1, _Ms> { // _IYMiss = _IYDia + _Ms-2
+		INLINE_FN_GEN2( void ) {
+			b[_Ms][_IYMiss] = /*b[eDiaIdx][_IYDia] ^*/ s
+				^ et_diagonal_indexer<2, _Ms-2, -1 >::gen(b)
+				^ et_diagonal_indexer<_Ms+1, _ND-_Ms-1, _IYMiss-1>::gen(b);
+		}
+	};
+	//expression template for recover x from diagonal block
+	template<int _IYMiss, int _IYDia, int _Ms>
+	class et_x_from_diagonal_block {
+		INLINE_FN_GEN2( void ) {
+			et_x_from_diagonal_block<_IYMiss-1, _IYDia-1, _Ms>::gen(b, s);
+			et_x_from_dia<_IYMiss, _IYDia, _Ms>::gen(b, s);
+		}
+	};
+	template<int _IYMiss, int _Ms>
+	class et_x_from_diagonal_block<_IYMiss, -1, _Ms> {
+		INLINE_FN_GEN2( void ) {
+			et_x_from_diagonal_block<_IYMiss-1, P-2, _Ms>::gen(b, s);
+			et_x_from_dia<_IYMiss, -1, _Ms>::gen(b, s);
+		}
+	};
+	template<  int _IYDia, int _Ms>
+	class et_x_from_diagonal_block<0, _IYDia, _Ms> {
+		INLINE_FN_GEN2( void ) {
+			s = b[eDiaIdx][_IYDia-1] ^ et_diagonal_indexer<2, _ND-2, _IYDia-1>::gen(b);
+			et_x_from_dia<0, _IYDia, _Ms>::gen(b, s);
+		}
+	};
+	template<  int _Ms>
+	class et_x_from_diagonal_block<0, 0, _Ms> {
+		INLINE_FN_GEN2( void ) {
+			s = /*b[eDiaIdx][_IYDia-1] ^*/ et_diagonal_indexer<2, _ND-2, -1>::gen(b);
+			et_x_from_dia<0, 0, _Ms>::gen(b, s);
+		}
+	};
+	template<  int _Ms>
+	class et_x_from_diagonal_block<0, -1, _Ms> {
+		INLINE_FN_GEN2( void ) {
+			s = b[eDiaIdx][P-2] ^ et_diagonal_indexer<2, _ND-2, P-2>::gen(b);
+			et_x_from_dia<0, -1, _Ms>::gen(b, s);
+		}
+	};
+	//expression template for recover Miss1 and Miss2
+	template<int _CY, int _IY, int _M1, int _M2>
+	class et_x1x2_block {
+		INLINE_FN_GEN2( void ) {
+			et_x1x2_block<_CY-1, (_IY-_M2+_M1+P)%P, _M1, _M2>::gen(b, s);
+			et_x_from_dia<_IY, (_IY+_M1-1)%P-1, _M1>::gen(b, s);
+			et_x_from_row<_IY, _M2>::gen(b); // now
+		}
+	};
+	template< int _IY, int _M1, int _M2>
+	class et_x1x2_block<1, _IY, _M1, _M2> {
+		INLINE_FN_GEN2( void ) {
+			s = et_syndrome<P-2, eDiaIdx, eRowIdx>::gen(b);
+			et_x_from_dia<_IY, (_IY+_M1-1)%P-1, _M1>::gen(b, s);
+			et_x_from_row<_IY, _M2>::gen(b); // now
+		}
+	};
+	//expression template for row parity check, or of the row differences 0 ~ _IY
+	template<int _CX, int _IY>
+	class et_row_check {
+		INLINE_FN_GEN1( T ) {
+			T v = et_row_check<_CX, _IY-1>::gen(b);
+			return v | ( b[eRowIdx][_IY] ^ et_row_indexer<2, _CX, _IY>::gen(b) );
+		}
+	};
+	template <int _CX>
+	class et_row_check<_CX, 0> {
+		INLINE_FN_GEN1( T ) {
+			return b[eRowIdx][0] ^ et_row_indexer<2, _CX, 0>::gen(b);
+		}
+	};
+	//expression template for diagonal parity check, same syndrome as et_diagonal_block
+	template<int _CX, int _IY>
+	class et_diagonal_check {
+		INLINE_FN_GEN2( T ) {
+			T v = et_diagonal_check<_CX, _IY-1>::gen(b, s);
+			return v | ( b[eDiaIdx][_IY] ^ et_diagonal_indexer<2, _CX, _IY>::gen(b) ^ s );
+		}
+	};
+	template<int _CX >
+	class et_diagonal_check<_CX, 0> {
+		INLINE_FN_GEN2( T ) {
+			s = et_diagonal_indexer<2, _CX, -1>::gen(b);
+			return b[eDiaIdx][0] ^ et_diagonal_indexer<2, _CX, 0>::gen(b) ^ s;
+		}
+	};
+public: //public verify interface
+	class verify_dr { public: //check both parities, read only
+		static int run(T** d, size_t c, size_t* bad) {
+			T* a[_ND], **b=a; 
+			for(int j=0; j<_ND; ++j) {a[j]=d[j];}
+			T syndrome;
+			for(size_t i=0, n=c/(P-1)*(P-1); i<n; i+=P-1){
+				T dr = et_row_check<_ND-2, P-2>::gen(b);
+				T dd = et_diagonal_check<_ND-2, P-2>::gen(b, syndrome);
+				if( dr | dd ) {
+					*bad = i;
+					return ( dd? 1<<eDiaIdx : 0 ) | ( dr? 1<<eRowIdx : 0 );
+				}
+				et_add_ptr<eDiaIdx, eRowIdx, _ND-1>::gen(b);
+			}
+			return 0;
+		}
+	};
+	template<class _CRC>
+	class encode_crc { public: //build both parities and run the crc of every disk, one pass
+		static int run(T** d, size_t c, unsigned* crc) {
+			T* a[_ND], **b=a; 
+			unsigned s[_ND];
+			for(int j=0; j<_ND; ++j) {a[j]=d[j]; s[j]=crc[j];}
+			T syndrome;
+			for(size_t i=c/(P-1); i>0; --i){
+				et_row_block<_ND-2, P-2>::gen(b);
+				et_diagonal_block<_ND-2, P-2>::gen(b, syndrome);
+				//the group is in L1 now, disks side by side keep the crc chains independent
+				for(int r=0; r<P-1; ++r) {
+					for(int j=0; j<_ND; ++j) {
+						s[j] = _CRC::update(s[j], a[j][r]);
+					}
+				}
+				et_add_ptr<eDiaIdx, eRowIdx, _ND-1>::gen(b);
+			}
+			for(int j=0; j<_ND; ++j) {crc[j]=s[j];}
+			return errOK;
+		}
+	};
+public: //public recover interface
+	#define run_head static int run(T** d, size_t c) { T* a[_ND], **b=a; for(int j=0; j<_ND; ++j) {a[j]=d[j];}
+
+	class recover_d { public: //recover diagonal parity
+		run_head
+		T syndrome = 0;
+		for(size_t i=c/(P-1); i>0; --i){
+			et_diagonal_block<_ND-2, P-2>::gen(b, syndrome);
+			et_add_ptr<eDiaIdx, 2, _ND-2>::gen(b);
+		}
+		return errOK;
+	}};
+	class recover_r { public: //recover row parity
+		run_head
+		for(size_t i=c/(P-1); i>0; --i) {
+			et_row_block<_ND-2, P-2>::gen(b);
+			et_add_ptr<eRowIdx, 2, _ND-2>::gen(b);
+		}
+		return errOK;
+	}};
+	template<int _Ms>
+	class recover_x_from_dia { public: //recover one data from diagonal
+		run_head
+		T syndrome = 0;
+		for(size_t i=c/(P-1); i>0; --i){
+			et_x_from_diagonal_block<P-2, (_Ms-3+P)%P-1, _Ms>::gen(b, syndrome);
+			et_add_ptr<eDiaIdx, 2, _ND-2>::gen(b);
+		}
+		return errOK;
+	}};
+	template<int _Ms>
+	class recover_x_from_row { public: //recover one data from row
+		run_head
+		for(size_t i=c/(P-1); i>0; --i){
+			et_x_from_row_block<P-2, _Ms>::gen(b);
+			et_add_ptr<eRowIdx, 2, _ND-2>::gen(b);
+		}
+		return errOK;
+	}};
+	template<int _Ms>
+	class recover_x { public: //recover one data, both from dia and from row are ok
+		static int run(T** b, size_t c) {            
+			return recover_x_from_dia<_Ms>::run(b, c);	//use diagonal here since recover_bigN need this!
+			//return recover_x_from_row<_Ms>::run(b, c);
+		}
+	};
+	class recover_dr { public: //recover both diagonal and row parity
+		run_head
+		T syndrome;
+		for(size_t i=c/(P-1); i>0; --i){
+			et_row_block<_ND-2, P-2>::gen(b);
+			et_diagonal_block<_ND-2, P-2>::gen(b, syndrome);
+			et_add_ptr<eDiaIdx, eRowIdx, _ND-1>::gen(b);
+		}
+		return errOK;
+	}};
+	template<int _Ms>
+	class recover_dx { public: //recover diagonal and one data
+		run_head
+		T syndrome;
+		for(size_t i=c/(P-1); i>0; --i){
+			et_x_from_row_block<P-2, _Ms>::gen(b);
+			et_diagonal_block<_ND-2, P-2>::gen(b, syndrome);
+			et_add_ptr<eDiaIdx, eRowIdx, _ND-1>::gen(b);
+		}
+		return errOK;
+	}};
+	template<int _Ms>
+	class recover_rx { public: //recover row and one data
+		run_head
+		T syndrome = 0;
+		for(size_t i=c/(P-1); i>0; --i){
+			et_x_from_diagonal_block<P-2, (_Ms-3+P)%P-1, _Ms>::gen(b, syndrome);
+			et_row_block<_ND-2, P-2>::gen(b);
+			et_add_ptr<eDiaIdx, eRowIdx, _ND-1>::gen(b);
+		}
+		return errOK;
+	}};
+	template<int _M1, int _M2>
+	class recover_xx { public:  //recover two data disk
+		run_head
+		T syndrome = 0;
+		for(size_t i=c/(P-1); i>0; --i){
+			et_x1x2_block<P-1, P-1-_M2+_M1, _M1, _M2>::gen(b, syndrome);
+			et_add_ptr<eDiaIdx, eRowIdx, _ND-1>::gen(b);
+		}
+		return errOK;
+	}};
+private: //to help generic wraper
+	template<int _M1, int _M2, bool> class traits_2 {public: typedef recover_xx<_M1, _M2> imp; };
+	template<int _M1, int _M2> class traits_2<_M1, _M2, true> {public: typedef recover_x<_M1> imp; };
+public:  //generic wraper, the NOUSE just to prevent gcc error
+	template<int _M1, int _M2, int NOUSE> class traits {public: typedef typename traits_2<_M1, _M2, _M1==_M2>::imp imp; };
+	template<int _Ms, int NOUSE> class traits<0, _Ms, NOUSE> {public: typedef recover_dx<_Ms> imp; };
+	template<int _Ms, int NOUSE> class traits<1, _Ms, NOUSE> {public: typedef recover_rx<_Ms> imp; };	
+	template<int NOUSE> class traits<0, 0, NOUSE> {public: typedef recover_d	imp; };
+	template<int NOUSE> class traits<1, 1, NOUSE> {public: typedef recover_r	imp; };
+	template<int NOUSE> class traits<0, 1, NOUSE> {public: typedef recover_dr	imp; };
+
+};//generic raid6 
+
+//*****************************************************************************    
+//class CGenericUpdate: read-modify-write of both parities for one data disk. 
+//Purpose:
+//  A change on data disk _Ms flips the row parity in place, and the diagonal 
+//  parity along the shifted rows plus the syndrome of the imaginary diagonal, 
+//  which moves to every diagonal row. Only the data and parities are touched, 
+//  not the other disks.
+//Template arguements naming :
+//  _Ms:    the changed data disk index, 2 ~ eImpDiskNum-1.
+//  _Diff:  true if the new data buffer holds old^new already.
+//  _P:     the Prime, named P in the class
+//Comment:
+//  run(b, c) takes b = {diagonal, row, old data, new data or diff}.
+//*****************************************************************************
+template <int _Ms, int _P = P>
+class CGenericUpdate{
+public:
+	enum { P = _P };
+private:
+	enum {
+		eOld	= 2,					//old data in block
+		eNew	= 3,					//new data or diff in block
+		eK		= _Ms-2,				//diagonal shift of this disk
+		eSy		= (P-1-eK)%P,			//data row on the imaginary diagonal, P-1 if none
+	};
+	//expression template for data delta of row _IY, the imaginary row is 0
+	template<int _IY, bool _Diff, bool _Imaginary>
+	class et_delta {
+		INLINE_FN_GEN1( T ) {
+			return b[eOld][_IY] ^ b[eNew][_IY];
+		}
+	};
+	template<int _IY>
+	class et_delta<_IY, true, false> {
+		INLINE_FN_GEN1( T ) {
+			return b[eNew][_IY];
+		}
+	};
+	template<int _IY, bool _Diff>
+	class et_delta<_IY, _Diff, true> {
+		INLINE_FN_GEN1( T ) {
+			return 0;
+		}
+	};
+	//expression template for update parities row 0 ~ _IY
+	template<int _IY, bool _Diff>
+	class et_update_block {
+		INLINE_FN_GEN2( void ) {
+			et_update_block<_IY-1, _Diff>::gen(b, s);
+			b[eRowIdx][_IY] ^= et_delta<_IY, _Diff, false>::gen(b);
+			b[eDiaIdx][_IY] ^= et_delta<(_IY-eK+P)%P, _Diff, (_IY-eK+P)%P==P-1>::gen(b) ^ s;
+		}
+	};
+	template<bool _Diff>
+	class et_update_block<0, _Diff> {
+		INLINE_FN_GEN2( void ) {
+			s = et_delta<eSy, _Diff, eSy==P-1>::gen(b);
+			b[eRowIdx][0] ^= et_delta<0, _Diff, false>::gen(b);
+			b[eDiaIdx][0] ^= et_delta<(P-eK)%P, _Diff, (P-eK)%P==P-1>::gen(b) ^ s;
+		}
+	};
+public:
+	template<bool _Diff>
+	class update_x { public:
+		static int run(T** d, size_t c) {
+			T* a[4], **b=a; 
+			for(int j=0; j<4; ++j) {a[j]=d[j];}
+			T syndrome;
+			for(size_t i=c/(P-1); i>0; --i) {
+				et_update_block<P-2, _Diff>::gen(b, syndrome);
+				a[eDiaIdx] += (P-1); a[eRowIdx] += (P-1); a[eOld] += (P-1); a[eNew] += (P-1);
+			}
+			return errOK;
+		}
+	};
+};//generic update 
+
+//*****************************************************************************    
+//class CLoopRaid6: raid6 kernels with runtime disk number and missing disks. 
+//Purpose:
+//  Serve the arrays above the unrolled tables, up to P+2 disks, with a code
+//  size independent of the disk number. Same on disk layout as CGenericRaid6.
+//Template arguements naming :
+//  _P:     the Prime, named P in the class
+//Comment:
+//  a group is first reduced to the syndromes of the surviving data disks:
+//  row[r] = xor of d[r], dia[i] = xor of d[(i-k) mod P], k = disk-2, i = P-1
+//  is the imaginary diagonal. the missing blocks are then solved from them.
+//*****************************************************************************
+template <int _P>
+class CLoopRaid6{
+public:
+	enum { P = _P };
+private:
+	//software prefetch of the group ePrefetchBytes ahead, see eRunPrefetch
+	static inline void prefetch_group(const T* v) {
+	#ifdef LIB_GCC4_1_OPTIMIZE_ENABLED
+		for(int o=0; o<P-1; o+=64/sizeof(T)) {
+			__builtin_prefetch( v + raid6_config_tag::ePrefetchBytes/sizeof(T) + o );
+		}
+	#endif
+	}
+	//syndromes of one group, skipping disks m1, m2, the next groups prefetched if pf
+	static inline void syndrome(T** b, size_t off, int nd, int m1, int m2, T* row, T* dia, int pf) {
+		for(int i=0; i<P; ++i) {
+			row[i] = 0; dia[i] = 0;
+		}
+		for(int d=2; d<nd; ++d) {
+			if(d==m1 || d==m2) continue;
+			const T* v = b[d] + off;
+			if(pf) prefetch_group(v);
+			int i = d-2;
+			for(int r=0; r<P-1; ++r) {
+				row[r] ^= v[r];
+				dia[i] ^= v[r];
+				if(++i==P) i = 0;
+			}
+		}
+	}
+public:
+	//recover missing m1, m2 (m1<=m2) of nd disks, c base_type units each
+	static int recover(T** b, size_t c, int nd, int m1, int m2) {
+		T row[P], dia[P];
+		int pf = gRunFlags & eRunPrefetch;
+		for(size_t off=0; off+(P-1)<=c; off+=(P-1)) {
+			syndrome(b, off, nd, m1, m2, row, dia, pf);
+			T* pd = b[eDiaIdx] + off;
+			T* pr = b[eRowIdx] + off;
+			if(m1==eDiaIdx && m2==eDiaIdx) {
+				for(int i=0; i<P-1; ++i) pd[i] = dia[i] ^ dia[P-1];
+			}
+			else if(m1==eRowIdx && m2==eRowIdx) {
+				for(int r=0; r<P-1; ++r) pr[r] = row[r];
+			}
+			else if(m1==eDiaIdx && m2==eRowIdx) {
+				for(int r=0; r<P-1; ++r) pr[r] = row[r];
+				for(int i=0; i<P-1; ++i) pd[i] = dia[i] ^ dia[P-1];
+			}
+			else if(m1==m2) {	//one data from diagonal, the same parity the unrolled kernels read
+				T* px = b[m1] + off;
+				int k = m1-2;
+				T z0 = (P-1+k)%P==P-1? 0 : pd[(P-1+k)%P] ^ dia[(P-1+k)%P] ^ dia[P-1];
+				int i = k;
+				for(int r=0; r<P-1; ++r) {
+					px[r] = ( i==P-1? 0 : pd[i] ^ dia[i] ^ dia[P-1] ) ^ z0;
+					if(++i==P) i = 0;
+				}
+			}
+			else if(m1==eDiaIdx) {	//data from row, then diagonal
+				T* px = b[m2] + off;
+				int i = m2-2;
+				for(int r=0; r<P-1; ++r) {
+					px[r] = pr[r] ^ row[r];
+					dia[i] ^= px[r];
+					if(++i==P) i = 0;
+				}
+				for(int i=0; i<P-1; ++i) pd[i] = dia[i] ^ dia[P-1];
+			}
+			else if(m1==eRowIdx) {	//data from diagonal, z[i] = x[i-k] ^ x[P-1-k], then row
+				T* px = b[m2] + off;
+				int k = m2-2;
+				T z0 = (P-1+k)%P==P-1? 0 : pd[(P-1+k)%P] ^ dia[(P-1+k)%P] ^ dia[P-1];
+				int i = k;
+				for(int r=0; r<P-1; ++r) {
+					px[r] = ( i==P-1? 0 : pd[i] ^ dia[i] ^ dia[P-1] ) ^ z0;
+					pr[r] = row[r] ^ px[r];
+					if(++i==P) i = 0;
+				}
+			}
+			else {	//two data, zig-zag from the diagonal whose m2 row is imaginary
+				T* px = b[m1] + off;
+				T* py = b[m2] + off;
+				int kx = m1-2, ky = m2-2;
+				T s = 0;
+				for(int r=0; r<P-1; ++r) s ^= pd[r] ^ pr[r];
+				int i = (P-1+ky)%P;
+				T y = 0;
+				for(int step=0; step<P-1; ++step) {
+					int r = (i-kx+P)%P;
+					px[r] = ( i==P-1? dia[i] : pd[i]^dia[i] ) ^ s ^ y;
+					y = py[r] = pr[r] ^ row[r] ^ px[r];
+					i = (r+ky)%P;
+				}
+			}
+		}
+		return errOK;
+	}
+	//check both parities of nd disks, the mask of the first bad group is returned, its offset in *bad
+	static int verify(T** b, size_t c, int nd, size_t* bad) {
+		T row[P], dia[P];
+		int pf = gRunFlags & eRunPrefetch;
+		for(size_t off=0; off+(P-1)<=c; off+=(P-1)) {
+			syndrome(b, off, nd, -1, -1, row, dia, pf);
+			const T* pd = b[eDiaIdx] + off;
+			const T* pr = b[eRowIdx] + off;
+			T dr = 0, dd = 0;
+			for(int r=0; r<P-1; ++r) {
+				dr |= pr[r] ^ row[r];
+				dd |= pd[r] ^ dia[r] ^ dia[P-1];
+			}
+			if( dr | dd ) {
+				*bad = off;
+				return ( dd? 1<<eDiaIdx : 0 ) | ( dr? 1<<eRowIdx : 0 );
+			}
+		}
+		return 0;
+	}
+	//the only disk whose corruption explains the syndromes of group b, -1 if none.
+	//a data disk k=d-2 with error e gives row syndrome e and diagonal syndrome
+	//D[i] = e[(i-k) mod P] ^ e[P-1-k], a parity disk leaves the other syndrome clean.
+	static int locate(T** b, int nd) {
+		T row[P], dia[P];
+		syndrome(b, 0, nd, -1, -1, row, dia, 0);
+		int rowBad = 0, diaBad = 0;
+		for(int r=0; r<P-1; ++r) {
+			row[r] ^= b[eRowIdx][r];
+			dia[r] ^= b[eDiaIdx][r] ^ dia[P-1];
+			rowBad |= row[r]!=0;
+			diaBad |= dia[r]!=0;
+		}
+		row[P-1] = 0;
+		if(!rowBad) return diaBad? eDiaIdx : -1;
+		if(!diaBad) return eRowIdx;
+		for(int d=2; d<nd; ++d) {
+			int k = d-2;
+			T s = row[(P-1-k)%P];
+			int j = (P-k)%P, i = 0;
+			for(; i<P-1 && dia[i]==(row[j]^s); ++i) {
+				if(++j==P) j = 0;
+			}
+			if(i==P-1) return d;
+		}
+		return -1;
+	}
+	//update both parities for data disk dataIdx, b = {diagonal, row, old data, new data or diff}
+	static int update(T** b, size_t c, int dataIdx, int mode) {
+		int k = dataIdx-2;
+		T delta[P];
+		delta[P-1] = 0;
+		for(size_t off=0; off+(P-1)<=c; off+=(P-1)) {
+			T* pd = b[eDiaIdx] + off;
+			T* pr = b[eRowIdx] + off;
+			const T* po = b[2] + off;
+			const T* pn = b[3] + off;
+			for(int r=0; r<P-1; ++r) {
+				delta[r] = mode==eUpdateDiff? pn[r] : po[r]^pn[r];
+				pr[r] ^= delta[r];
+			}
+			T s = delta[(P-1-k)%P];
+			int j = (P-k)%P;
+			for(int i=0; i<P-1; ++i) {
+				pd[i] ^= delta[j] ^ s;
+				if(++j==P) j = 0;
+			}
+		}
+		return errOK;
+	}
+};//loop raid6 
+
+//*****************************************************************************    
+//class CLoopStar: STAR triple parity kernels with runtime disk number and missing disks. 
+//Purpose:
+//  EVENODD plus an anti-diagonal parity of the opposite slope, any three members
+//  recovered. The first nd-1 disks are the array of CLoopRaid6, the anti-diagonal 
+//  parity is the last one: A[i] = a[i] ^ a[P-1], a[i] = xor of d[(i+k) mod P].
+//Template arguements naming :
+//  _P:     the Prime, named P in the class
+//Comment:
+//  a column k is the polynomial X_k(z) = sum x[r] z^r over the ring GF(2)[z]/M(z),
+//  M(z) = 1+z+..+z^(P-1), a vector of P units with x[P-1] = 0 in canonical form. 
+//  the row, diagonal and anti-diagonal syndromes of the missing columns are then
+//  sum X_k, sum z^k X_k and sum z^-k X_k, solved with rotations and divisions by
+//  1+z^j, a zig-zag through the P units. the code is MDS as P is prime.
+//*****************************************************************************
+template <int _P>
+class CLoopStar{
+public:
+	enum { P = _P };
+	enum { eRow = 0, eDia = 1, eAnti = 2 };	//the parities, by slope
+private:
+	static inline int mod(int j) {
+		j %= P;
+		return j<0? j+P : j;
+	}
+	//acc[(r+j) mod P] ^= v[r] over the P-1 rows, in two runs the compiler could vectorize
+	static inline void xor_rot(const T* v, int j, T* acc) {
+		int n = P-j<P-1? P-j : P-1;
+		for(int r=0; r<n; ++r) acc[r+j] ^= v[r];
+		for(int r=n; r<P-1; ++r) acc[r+j-P] ^= v[r];
+	}
+	//canonical form, unit P-1 zero, by adding M(z)
+	static inline void canon(T* v) {
+		T t = v[P-1];
+		for(int i=0; i<P; ++i) v[i] ^= t;
+	}
+	//out = z^j v
+	static inline void rot(const T* v, int j, T* out) {
+		j = mod(j);
+		for(int i=0; i<P; ++i) out[ i+j<P? i+j : i+j-P ] = v[i];
+		canon(out);
+	}
+	//out = v / (1+z^j), j not 0 mod P. v plus M(z) if needed is a multiple of 1+z 
+	//over z^P-1, then y[i] = w[i] ^ y[i-j] from y[P-1] = 0.
+	static inline void div1(const T* v, int j, T* out) {
+		j = mod(j);
+		T par = 0;
+		for(int i=0; i<P; ++i) par ^= v[i];
+		int i = P-1;
+		out[i] = 0;
+		for(int step=1; step<P; ++step) {
+			int n = i+j<P? i+j : i+j-P;
+			out[n] = v[n] ^ par ^ out[i];
+			i = n;
+		}
+	}
+	static inline void xor_to(T* a, const T* b) {
+		for(int i=0; i<P; ++i) a[i] ^= b[i];
+	}
+	//two columns a, b from the syndromes of slopes s, t:
+	//X_b = z^-tb (z^(t-s)a Es + Et) / (1 + z^(s-t)(b-a)), X_a = z^-sa (Es + z^sb X_b)
+	static inline void solve2(const T* es, const T* et, int s, int t, int a, int b, T* xa, T* xb) {
+		T u[P], w[P];
+		rot(es, (t-s)*a, u);
+		xor_to(u, et);
+		div1(u, (s-t)*(b-a), w);
+		rot(w, -t*b, xb);
+		rot(xb, s*b, u);
+		xor_to(u, es);
+		rot(u, -s*a, xa);
+	}
+	//syndromes of slope 0, 1, -1 of the data disks, skipping the missing ones
+	static inline void syndrome(T** b, size_t off, int nd, const int* miss, int numMiss, T (*syn)[P]) {
+		for(int i=0; i<P; ++i) {
+			syn[eRow][i] = 0; syn[eDia][i] = 0; syn[eAnti][i] = 0;
+		}
+		for(int d=2; d<nd-1; ++d) {
+			int m = 0;
+			while(m<numMiss && miss[m]!=d) ++m;
+			if(m<numMiss) continue;
+			const T* v = b[d] + off;
+			int k = d-2;
+			for(int r=0; r<P-1; ++r) syn[eRow][r] ^= v[r];
+			xor_rot(v, k, syn[eDia]);
+			xor_rot(v, mod(-k), syn[eAnti]);
+		}
+	}
+public:
+	//recover the numMiss (1~3) distinct missing disks of nd disks, c base_type units each
+	static int recover(T** b, size_t c, int nd, const int* miss, int numMiss) {
+		T syn[3][P], e[3][P], x[3][P];
+		T* parity[3] = { b[eRowIdx], b[eDiaIdx], b[nd-1] };
+		int col[3], numCol = 0, lost[3] = {0, 0, 0};
+		for(int m=0; m<numMiss; ++m) {
+			if(miss[m]==eRowIdx)		lost[eRow] = 1;
+			else if(miss[m]==eDiaIdx)	lost[eDia] = 1;
+			else if(miss[m]==nd-1)		lost[eAnti] = 1;
+			else col[numCol++] = miss[m]-2;
+		}
+		int use[3], numUse = 0;						//the surviving parities solved from, in this order
+		for(int t=0; t<3; ++t) {
+			if(!lost[t]) use[numUse++] = t;
+		}
+		if(numUse<numCol) return errInvalidMissIdx;
+		static const int slope[3] = { 0, 1, -1 };
+		for(size_t off=0; off+(P-1)<=c; off+=(P-1)) {
+			syndrome(b, off, nd, miss, numMiss, syn);
+			//e = sum z^(slope k) X_k of the missing columns, canonical
+			for(int t=0; t<3; ++t) {
+				if(lost[t]) continue;
+				const T* pp = parity[t] + off;
+				T adj = syn[t][P-1];
+				for(int i=0; i<P-1; ++i) e[t][i] = syn[t][i] ^ adj ^ pp[i];
+				e[t][P-1] = 0;
+			}
+			if(numCol==1) {
+				rot(e[use[0]], -slope[use[0]]*col[0], x[0]);
+			}
+			else if(numCol==2) {
+				solve2(e[use[0]], e[use[1]], slope[use[0]], slope[use[1]], col[0], col[1], x[0], x[1]);
+			}
+			else if(numCol==3) {
+				//X_c = z^(c-a-b) (z^a R + D + z^(a+b) (z^-a R + A)) / (1+z^(c-a)) / (1+z^(c-b))
+				int ka = col[0], kb = col[1], kc = col[2];
+				T u[P], v[P], w[P];
+				rot(e[eRow], ka, u);
+				xor_to(u, e[eDia]);
+				rot(e[eRow], -ka, w);
+				xor_to(w, e[eAnti]);
+				rot(w, ka+kb, v);
+				xor_to(u, v);
+				div1(u, kc-ka, w);
+				div1(w, kc-kb, v);
+				rot(v, kc-ka-kb, x[2]);
+				//then a, b from the row and diagonal without c
+				xor_to(e[eRow], x[2]);
+				rot(x[2], kc, u);
+				xor_to(e[eDia], u);
+				solve2(e[eRow], e[eDia], 0, 1, ka, kb, x[0], x[1]);
+			}
+			for(int m=0; m<numCol; ++m) {
+				T* px = b[col[m]+2] + off;
+				for(int r=0; r<P-1; ++r) px[r] = x[m][r];
+				xor_rot(x[m], 0, syn[eRow]);
+				xor_rot(x[m], col[m], syn[eDia]);
+				xor_rot(x[m], mod(-col[m]), syn[eAnti]);
+			}
+			//the lost parities from the whole data
+			for(int t=0; t<3; ++t) {
+				if(!lost[t]) continue;
+				T* pp = parity[t] + off;
+				T adj = t==eRow? 0 : syn[t][P-1];
+				for(int i=0; i<P-1; ++i) pp[i] = syn[t][i] ^ adj;
+			}
+		}
+		return errOK;
+	}
+};//loop star 
+
+//*****************************************************************************    
+//class CVectorRaid6: the generic raid6 class on simd lanes. 
+//Purpose:
+//  Same recover interface and on disk layout as CGenericRaid6, but an expression 
+//  works on a lane of eWidth adjacent rows in a (P-1)-row group. A diagonal lane
+//  is the xor of each disk loaded shifted by its diagonal offset, see _LT::rot.
+//Template arguements naming:
+//  same as CGenericRaid6, and
+//  _LT:    lane type, provides:
+//            ePrime                        the Prime, named P in the class
+//            type, eWidth                  vector of eWidth T
+//            zero(), set1(t), vxor(a,b)    
+//            load(p), store(p,v)           unaligned load/store of eWidth T
+//            stream(p,v), fence()          aligned store past the cache, and the fence after
+//            prefetch(p)                   software prefetch of the line at p
+//            rot<_K,_V>(p)                 lane e = p[(_V*eWidth+e-_K) mod P], p[P-1] reads as 0 
+//  _V:     lane index in the group, 0 ~ eNV-1
+//  _K:     diagonal shift, 0 ~ P-1
+//  _K0:    shift of the result, 0 for diagonal parity, _Ms-2 when solving data _Ms
+//  _S1,_S2 disks skipped by the expression, -1 for none
+//  _WD:    whether the diagonal parity takes part in the expression
+//  _Out:   disk the lane is stored to
+//  _NT:    whether _Out is stored past the cache, it is not read again soon
+//Comment:
+//  (P-1) should be a multiple of eWidth. with eRunPrefetch in gRunFlags the inputs
+//  are prefetched ePrefetchBytes ahead, with eRunStream the kernels whose outputs
+//  are not read back stream them if they are aligned to the lane.
+//*****************************************************************************
+template <int _ND, class _LT>
+class CVectorRaid6{
+public:
+	typedef typename _LT::type lane_t;
+	enum { P = _LT::ePrime };
+	enum { eW = _LT::eWidth, eNV = (P-1)/_LT::eWidth };
+	enum { 
+		ePfUnits = raid6_config_tag::ePrefetchBytes/sizeof(T),		//prefetch distance
+		eLine    = 64/sizeof(T),									//units per cache line
+	};
+private: //core expressions
+	//expression template for lane _V of disk _Of, zero if skipped
+	template<int _Of, int _V, bool _Skip>
+	class et_vterm {
+		INLINE_FN_GEN1( lane_t ) {
+			return _LT::load( b[_Of] + _V*eW );
+		}
+	};
+	template<int _Of, int _V>
+	class et_vterm<_Of, _V, true> {
+		INLINE_FN_GEN1( lane_t ) {
+			return _LT::zero();
+		}
+	};
+	//expression template for row lane, xor of disks _Of ~ _Of+_CX-1
+	template<int _Of, int _CX, int _V, int _S1, int _S2>
+	class et_vrow_indexer {
+		INLINE_FN_GEN1( lane_t ) {
+			return _LT::vxor( et_vterm<_Of, _V, _Of==_S1 || _Of==_S2>::gen(b),
+				et_vrow_indexer<_Of+1, _CX-1, _V, _S1, _S2>::gen(b) );
+		}
+	};
+	template<int _Of, int _V, int _S1, int _S2>
+	class et_vrow_indexer<_Of, 0, _V, _S1, _S2> {
+		INLINE_FN_GEN1( lane_t ) {
+			return _LT::zero();
+		}
+	};
+	//expression template for lane _V of disk _Of shifted by _K, zero if skipped
+	template<int _Of, int _K, int _V, bool _Skip>
+	class et_vrot {
+		INLINE_FN_GEN1( lane_t ) {
+			return _LT::template rot<_K, _V>( b[_Of] );
+		}
+	};
+	template<int _Of, int _K, int _V>
+	class et_vrot<_Of, _K, _V, true> {
+		INLINE_FN_GEN1( lane_t ) {
+			return _LT::zero();
+		}
+	};
+	//expression template for diagonal lane, xor of data disks _Of ~ _Of+_CX-1
+	template<int _Of, int _CX, int _K0, int _V, int _S1, int _S2>
+	class et_vdiagonal_indexer {
+		INLINE_FN_GEN1( lane_t ) {
+			return _LT::vxor( et_vrot<_Of, (_Of-2-_K0+P)%P, _V, _Of==_S1 || _Of==_S2>::gen(b),
+				et_vdiagonal_indexer<_Of+1, _CX-1, _K0, _V, _S1, _S2>::gen(b) );
+		}
+	};
+	template<int _Of, int _K0, int _V, int _S1, int _S2>
+	class et_vdiagonal_indexer<_Of, 0, _K0, _V, _S1, _S2> {
+		INLINE_FN_GEN1( lane_t ) {
+			return _LT::zero();
+		}
+	};
+	//expression template for element _IY of disk _Of, zero if skipped
+	template<int _Of, int _IY, bool _Skip>
+	class et_sterm {
+		INLINE_FN_GEN1( T ) {
+			return b[_Of][_IY];
+		}
+	};
+	template<int _Of, int _IY>
+	class et_sterm<_Of, _IY, true> {
+		INLINE_FN_GEN1( T ) {
+			return 0;
+		}
+	};
+	//expression template for one element of diagonal _IY, xor of data disks _Of ~ _Of+_CX-1
+	template<int _Of, int _CX, int _IY, int _S1, int _S2>
+	class et_sdiagonal_indexer {
+		INLINE_FN_GEN1( T ) {
+			return et_sterm<_Of, (_IY-_Of+2+P)%P, _Of==_S1 || _Of==_S2 || (_IY-_Of+2+P)%P==P-1>::gen(b) 
+				^ et_sdiagonal_indexer<_Of+1, _CX-1, _IY, _S1, _S2>::gen(b);
+		}
+	};
+	template<int _Of, int _IY, int _S1, int _S2>
+	class et_sdiagonal_indexer<_Of, 0, _IY, _S1, _S2> {
+		INLINE_FN_GEN1( T ) {
+			return 0;
+		}
+	};
+	//expression template for diagonal _IY with its parity, the imaginary diagonal P-1 has none
+	template<int _IY, int _S1, int _S2>
+	class et_sdiagonal_syndrome {
+		INLINE_FN_GEN1( T ) {
+			return et_sterm<eDiaIdx, _IY, _IY==P-1>::gen(b)
+				^ et_sdiagonal_indexer<2, _ND-2, _IY, _S1, _S2>::gen(b);
+		}
+	};
+	//store of an output lane
+	template<bool _NT>
+	static inline void out_store(T* p, lane_t v) {
+		if(_NT) _LT::stream(p, v);
+		else	_LT::store(p, v);
+	}
+	//lane functors, store lane _V of disk _Out
+	template<int _Out, int _Of, int _S1, int _S2, bool _NT = false>
+	class f_row { public: //xor of disks _Of ~ _ND-1 in row
+		template<int _V> class lane {
+			INLINE_FN_VGEN( void ) {
+				out_store<_NT>( b[_Out] + _V*eW, et_vrow_indexer<_Of, _ND-_Of, _V, _S1, _S2>::gen(b) );
+			}
+		};
+	};
+	template<int _Out, int _K0, int _S1, int _S2, bool _WD, bool _NT = false>
+	class f_diagonal { public: //s ^ xor of the diagonals, shifted back by _K0
+		template<int _V> class lane {
+			INLINE_FN_VGEN( void ) {
+				out_store<_NT>( b[_Out] + _V*eW, _LT::vxor( 
+					_LT::vxor( s, et_vrot<eDiaIdx, (P-_K0)%P, _V, !_WD>::gen(b) ), 
+					et_vdiagonal_indexer<2, _ND-2, _K0, _V, _S1, _S2>::gen(b) ) );
+			}
+		};
+	};
+	//expression template for all lanes of a group
+	template<class _F, int _V>
+	class et_vblock {
+		INLINE_FN_VGEN( void ) {
+			et_vblock<_F, _V-1>::gen(b, s);
+			_F::template lane<_V>::gen(b, s);
+		}
+	};
+	template<class _F>
+	class et_vblock<_F, 0> {
+		INLINE_FN_VGEN( void ) {
+			_F::template lane<0>::gen(b, s);
+		}
+	};
+	//prefetch the group ePrefetchBytes ahead of every disk but the outputs _O1, _O2
+	static inline void prefetch_group(T** a, int _O1, int _O2) {
+		for(int j=0; j<_ND; ++j) {
+			if(j==_O1 || j==_O2) continue;
+			for(int o=0; o<P-1; o+=eLine) {
+				_LT::prefetch( a[j] + ePfUnits + o );
+			}
+		}
+	}
+	//walk the buffers one (P-1)-row group each step
+	template<class K, int _O1, int _O2>
+	class et_vrunner { public:
+		static int run(T** d, size_t c) {
+			T* a[_ND], **b=a;
+			for(int j=0; j<_ND; ++j) {a[j]=d[j];}
+			int pf = gRunFlags & eRunPrefetch;
+			for(size_t i=c/(P-1); i>0; --i){
+				if(pf) prefetch_group(a, _O1, _O2);
+				K::gen(b);
+				for(int j=0; j<_ND; ++j) {a[j] += P-1;}
+			}
+			return errOK;
+		}
+	};
+	//two stage kernel, stage K2 runs one group behind K1 so that it reads what K1 
+	//stored a step earlier instead of stalling on the store just issued. 
+	template<class K1, class K2, int _O1, int _O2>
+	class et_vrunner2 { public:
+		static int run(T** d, size_t c) {
+			T* a[_ND], **b=a;
+			T* q[_ND], **bq=q;
+			for(int j=0; j<_ND; ++j) {a[j]=d[j]; q[j]=d[j];}
+			int pf = gRunFlags & eRunPrefetch;
+			K1::gen(b);
+			for(size_t i=c/(P-1); i>1; --i){
+				for(int j=0; j<_ND; ++j) {a[j] += P-1;}
+				if(pf) prefetch_group(a, _O1, _O2);
+				K1::gen(b);
+				K2::gen(bq);
+				for(int j=0; j<_ND; ++j) {q[j] += P-1;}
+			}
+			K2::gen(bq);
+			return errOK;
+		}
+	};
+	//streaming kernel KNT if the call asks for it and the outputs are aligned to the lane, K if not
+	template<class K, class KNT, int _O1, int _O2>
+	class et_vrunner_nt { public:
+		static int run(T** d, size_t c) {
+			enum { eMask = eW*sizeof(T)-1 };
+			if( (gRunFlags & eRunStream) && ( ( (size_t)d[_O1] | (size_t)d[_O2] ) & eMask )==0 ) {
+				et_vrunner<KNT, _O1, _O2>::run(d, c);
+				_LT::fence();
+				return errOK;
+			}
+			return et_vrunner<K, _O1, _O2>::run(d, c);
+		}
+	};
+	//group generators, outputs stored past the cache if _NT
+	template<bool _NT>
+	class gen_d { public:
+		INLINE_FN_GEN1( void ) {
+			lane_t s = _LT::set1( et_sdiagonal_indexer<2, _ND-2, P-1, -1, -1>::gen(b) );
+			et_vblock< f_diagonal<eDiaIdx, 0, -1, -1, false, _NT>, eNV-1 >::gen(b, s);
+		}
+	};
+	template<bool _NT>
+	class gen_r { public:
+		INLINE_FN_GEN1( void ) {
+			et_vblock< f_row<eRowIdx, 2, -1, -1, _NT>, eNV-1 >::gen(b, _LT::zero());
+		}
+	};
+	template<bool _NT>
+	class gen_dr { public:
+		INLINE_FN_GEN1( void ) {
+			gen_r<_NT>::gen(b);
+			gen_d<_NT>::gen(b);
+		}
+	};
+	template<int _Ms, bool _NT>
+	class gen_x_from_dia { public:
+		INLINE_FN_GEN1( void ) {
+			lane_t s = _LT::set1( et_sdiagonal_syndrome<(_Ms-3+P)%P, _Ms, _Ms>::gen(b) );
+			et_vblock< f_diagonal<_Ms, _Ms-2, _Ms, _Ms, true, _NT>, eNV-1 >::gen(b, s);
+		}
+	};
+public: //public recover interface
+	#define run_vkernel( K, O1, O2 ) static int run(T** d, size_t c) { return et_vrunner<K, O1, O2>::run(d, c); }
+	#define run_vkernel_nt( G, O1, O2 ) static int run(T** d, size_t c) { return et_vrunner_nt<G<false>, G<true>, O1, O2>::run(d, c); }
+
+	class recover_d { public: //recover diagonal parity
+		INLINE_FN_GEN1( void ) {
+			gen_d<false>::gen(b);
+		}
+		run_vkernel_nt( gen_d, eDiaIdx, eDiaIdx )
+	};
+	class recover_r { public: //recover row parity
+		INLINE_FN_GEN1( void ) {
+			gen_r<false>::gen(b);
+		}
+		run_vkernel_nt( gen_r, eRowIdx, eRowIdx )
+	};
+	template<int _Ms>
+	class recover_x_from_dia { public: //recover one data from diagonal
+		template<bool _NT> class gen_x : public gen_x_from_dia<_Ms, _NT> {};
+		INLINE_FN_GEN1( void ) {
+			gen_x_from_dia<_Ms, false>::gen(b);
+		}
+		run_vkernel_nt( gen_x, _Ms, _Ms )
+	};
+	template<int _Ms>
+	class recover_x_from_row { public: //recover one data from row
+		INLINE_FN_GEN1( void ) {
+			et_vblock< f_row<_Ms, eRowIdx, _Ms, _Ms>, eNV-1 >::gen(b, _LT::zero());
+		}
+		run_vkernel( recover_x_from_row, _Ms, _Ms )
+	};
+	template<int _Ms>
+	class recover_x { public: //recover one data, same choice as CGenericRaid6
+		static int run(T** b, size_t c) {            
+			return recover_x_from_dia<_Ms>::run(b, c);
+		}
+	};
+	class recover_dr { public: //recover both diagonal and row parity
+		INLINE_FN_GEN1( void ) {
+			gen_dr<false>::gen(b);
+		}
+		run_vkernel_nt( gen_dr, eDiaIdx, eRowIdx )
+	};
+	template<int _Ms>
+	class recover_dx { public: //recover diagonal and one data
+		static int run(T** d, size_t c) { 
+			return et_vrunner2< recover_x_from_row<_Ms>, recover_d, eDiaIdx, _Ms >::run(d, c); 
+		}
+	};
+	template<int _Ms>
+	class recover_rx { public: //recover row and one data
+		INLINE_FN_GEN1( void ) {
+			recover_x_from_dia<_Ms>::gen(b);
+			recover_r::gen(b);
+		}
+		run_vkernel( recover_rx, eRowIdx, _Ms )
+	};
+	template<int _M1, int _M2>
+	class recover_xx { public:  //recover two data disk
+		//the row syndromes and diagonal syndromes are built in lanes into local 
+		//buffers, then the zig-zag chain of CGenericRaid6::et_x1x2_block resolves
+		//them element by element.
+		INLINE_FN_GEN1( void ) {
+			enum { eK1 = _M1-2, eK2 = _M2-2 };
+			T  r[P-1], e[P], s = 0, t;
+			T* x1 = b[_M1];
+			T* x2 = b[_M2];
+			int i, k, d;
+			b[_M1] = r;
+			b[_M2] = e;
+			et_vblock< f_row<_M1, eRowIdx, _M1, _M2>, eNV-1 >::gen(b, _LT::zero());
+			et_vblock< f_diagonal<_M2, 0, _M1, _M2, true>, eNV-1 >::gen(b, _LT::zero());
+			b[_M1] = x1;
+			b[_M2] = x2;
+			e[P-1] = et_sdiagonal_syndrome<P-1, _M1, _M2>::gen(b);
+			for(i=0; i<P-1; ++i) { 
+				s ^= b[eDiaIdx][i] ^ b[eRowIdx][i];
+			}
+			//start from the diagonal x2 not on, the next diagonal holds the x2 just solved
+			for(i=(eK2-eK1-1+P)%P, t=0, k=0; k<P-1; ++k) {
+				d = i + eK1;		//diagonal of x1[i]
+				if(d >= P) d -= P;
+				t = e[d] ^ s ^ t;	
+				x1[i] = t;
+				t = r[i] ^ t;
+				x2[i] = t;
+				i += eK2-eK1;
+				if(i >= P) i -= P;
+			}
+		}
+		run_vkernel( recover_xx, _M1, _M2 )
+	};
+	#undef run_vkernel
+	#undef run_vkernel_nt
+private: //to help generic wraper
+	template<int _M1, int _M2, bool> class traits_2 {public: typedef recover_xx<_M1, _M2> imp; };
+	template<int _M1, int _M2> class traits_2<_M1, _M2, true> {public: typedef recover_x<_M1> imp; };
+public:  //generic wraper, the NOUSE just to prevent gcc error
+	template<int _M1, int _M2, int NOUSE> class traits {public: typedef typename traits_2<_M1, _M2, _M1==_M2>::imp imp; };
+	template<int _Ms, int NOUSE> class traits<0, _Ms, NOUSE> {public: typedef recover_dx<_Ms> imp; };
+	template<int _Ms, int NOUSE> class traits<1, _Ms, NOUSE> {public: typedef recover_rx<_Ms> imp; };	
+	template<int NOUSE> class traits<0, 0, NOUSE> {public: typedef recover_d	imp; };
+	template<int NOUSE> class traits<1, 1, NOUSE> {public: typedef recover_r	imp; };
+	template<int NOUSE> class traits<0, 1, NOUSE> {public: typedef recover_dr	imp; };
+
+};//vector raid6
+
+//*****************************************************************************
+//class CLoopVectorRaid6: CLoopRaid6 on simd lanes.
+//Purpose:
+//  One recover kernel for every disk number and missing pair of a Prime, the
+//  code size does not grow with eImpDiskNum like the unrolled tables. the disk
+//  and row loops run at runtime, each step works on a lane of eWidth rows.
+//Template arguements naming:
+//  _LT:    lane type, see CVectorRaid6
+//Comment:
+//  the diagonals are built in a doubled accumulator, data k=d-2 adds its group
+//  at acc+k, so every disk is one run of unaligned lanes, no wrap; diagonal i is
+//  acc[i]^acc[i+P]. the single data solve reads a doubled syndrome the same way.
+//  (P-1) should be a multiple of eWidth.
+//*****************************************************************************
+template <class _LT>
+class CLoopVectorRaid6{
+public:
+	typedef typename _LT::type lane_t;
+	enum { P = _LT::ePrime };
+	enum { eW = _LT::eWidth, eAcc = (2*P+eW-1)/eW*eW };
+	enum {
+		ePfUnits = raid6_config_tag::ePrefetchBytes/sizeof(T),		//prefetch distance
+		eLine    = 64/sizeof(T),									//units per cache line
+	};
+private:
+	//row[r] = xor of d[r], acc[k+r] ^= d[r], skipping disks m1, m2, the next groups prefetched if pf
+	static inline void syndrome(T** b, size_t off, int nd, int m1, int m2, T* row, T* acc, int pf) {
+		for(int i=0; i<P-1; i+=eW) _LT::store( row + i, _LT::zero() );
+		for(int i=0; i<eAcc; i+=eW) _LT::store( acc + i, _LT::zero() );
+		for(int d=2; d<nd; ++d) {
+			if(d==m1 || d==m2) continue;
+			const T* v = b[d] + off;
+			T* a = acc + d-2;
+			if(pf) {
+				for(int o=0; o<P-1; o+=eLine) _LT::prefetch( v + ePfUnits + o );
+			}
+			for(int r=0; r<P-1; r+=eW) {
+				lane_t x = _LT::load( v + r );
+				_LT::store( row + r, _LT::vxor( _LT::load(row + r), x ) );
+				_LT::store( a + r, _LT::vxor( _LT::load(a + r), x ) );
+			}
+		}
+	}
+	//x[r] ^= acc[k+r] for data k
+	static inline void add_dia(const T* x, int k, T* acc) {
+		for(int r=0; r<P-1; r+=eW) {
+			_LT::store( acc + k + r, _LT::vxor( _LT::load(acc + k + r), _LT::load(x + r) ) );
+		}
+	}
+	//diagonals dia[0 ~ P-1] of the accumulator
+	static inline void fold(const T* acc, T* dia) {
+		for(int i=0; i<P-1; i+=eW) {
+			_LT::store( dia + i, _LT::vxor( _LT::load(acc + i), _LT::load(acc + P + i) ) );
+		}
+		dia[P-1] = acc[P-1] ^ acc[2*P-1];
+	}
+	//diagonal parity of the diagonals
+	static inline void store_dia(const T* dia, T* pd) {
+		lane_t s = _LT::set1( dia[P-1] );
+		for(int i=0; i<P-1; i+=eW) {
+			_LT::store( pd + i, _LT::vxor( _LT::load(dia + i), s ) );
+		}
+	}
+	//data k from the diagonal parity: z[i] = pd[i]^dia[i]^dia[P-1], z[P-1] = 0
+	//is doubled, then x[r] = z[r+k] ^ z[P-1+k]
+	static inline void solve_dia(const T* pd, const T* dia, int k, T* z, T* px) {
+		lane_t s = _LT::set1( dia[P-1] );
+		for(int i=0; i<P-1; i+=eW) {
+			lane_t v = _LT::vxor( _LT::vxor( _LT::load(pd + i), _LT::load(dia + i) ), s );
+			_LT::store( z + i, v );
+			_LT::store( z + P + i, v );
+		}
+		z[P-1] = 0;
+		lane_t z0 = _LT::set1( z[P-1+k] );
+		for(int r=0; r<P-1; r+=eW) {
+			_LT::store( px + r, _LT::vxor( _LT::load(z + k + r), z0 ) );
+		}
+	}
+	//out[r] = a[r]
+	static inline void copy_to(const T* a, T* out) {
+		for(int r=0; r<P-1; r+=eW) _LT::store( out + r, _LT::load(a + r) );
+	}
+	//out[r] = a[r] ^ b[r]
+	static inline void xor_to(const T* a, const T* b, T* out) {
+		for(int r=0; r<P-1; r+=eW) {
+			_LT::store( out + r, _LT::vxor( _LT::load(a + r), _LT::load(b + r) ) );
+		}
+	}
+public:
+	//recover missing m1, m2 (m1<=m2) of nd disks, c base_type units each
+	static int recover(T** b, size_t c, int nd, int m1, int m2) {
+		T row[P], dia[P], acc[eAcc], z[eAcc];
+		int pf = gRunFlags & eRunPrefetch;
+		for(size_t off=0; off+(P-1)<=c; off+=(P-1)) {
+			syndrome(b, off, nd, m1, m2, row, acc, pf);
+			T* pd = b[eDiaIdx] + off;
+			T* pr = b[eRowIdx] + off;
+			if(m1==eDiaIdx && m2==eDiaIdx) {
+				fold(acc, dia);
+				store_dia(dia, pd);
+			}
+			else if(m1==eRowIdx && m2==eRowIdx) {
+				copy_to(row, pr);
+			}
+			else if(m1==eDiaIdx && m2==eRowIdx) {
+				copy_to(row, pr);
+				fold(acc, dia);
+				store_dia(dia, pd);
+			}
+			else if(m1==m2) {	//one data from diagonal, the same parity the unrolled kernels read
+				fold(acc, dia);
+				solve_dia(pd, dia, m1-2, z, b[m1] + off);
+			}
+			else if(m1==eDiaIdx) {	//data from row, then diagonal
+				T* px = b[m2] + off;
+				xor_to(pr, row, px);
+				add_dia(px, m2-2, acc);
+				fold(acc, dia);
+				store_dia(dia, pd);
+			}
+			else if(m1==eRowIdx) {	//data from diagonal, then row
+				T* px = b[m2] + off;
+				fold(acc, dia);
+				solve_dia(pd, dia, m2-2, z, px);
+				xor_to(row, px, pr);
+			}
+			else {	//two data, the zig-zag chain is serial, as CLoopRaid6
+				T* px = b[m1] + off;
+				T* py = b[m2] + off;
+				int kx = m1-2, ky = m2-2;
+				fold(acc, dia);
+				T s = 0;
+				for(int r=0; r<P-1; ++r) s ^= pd[r] ^ pr[r];
+				int i = (P-1+ky)%P;
+				T y = 0;
+				for(int step=0; step<P-1; ++step) {
+					int r = (i-kx+P)%P;
+					px[r] = ( i==P-1? dia[i] : pd[i]^dia[i] ) ^ s ^ y;
+					y = py[r] = pr[r] ^ row[r] ^ px[r];
+					i = (r+ky)%P;
+				}
+			}
+		}
+		return errOK;
+	}
+};//loop vector raid6
+
+//*****************************************************************************
+//struct lane_scalar
+//Purpose:
+//  Lane type of the scalar engine, one T per expression. The simd lane types 
+//  are defined in their own units, see CVectorRaid6.
+//*****************************************************************************
+template<int _P>
+struct lane_scalar {
+	enum { eWidth = 1, ePrime = _P };
+	template<int _ND> class engine { public: typedef CGenericRaid6<_ND, _P> type; };
+};
+
+//*****************************************************************************
+//et_index_seq, et_make_index_seq
+//  compile time sequence 0 ~ N-1, built by halves so the depth stays log(N)
+//*****************************************************************************
+template<int... I> struct et_index_seq { typedef et_index_seq type; };
+template<class S1, class S2> struct et_concat_seq;
+template<int... I1, int... I2> 
+struct et_concat_seq< et_index_seq<I1...>, et_index_seq<I2...> > { 
+	typedef et_index_seq<I1..., ( (int)sizeof...(I1) + I2 )...> type; 
+};
+template<int N> struct et_make_index_seq 
+	: et_concat_seq< typename et_make_index_seq<N/2>::type, typename et_make_index_seq<N-N/2>::type > {};
+template<> struct et_make_index_seq<0> { typedef et_index_seq<> type; };
+template<> struct et_make_index_seq<1> { typedef et_index_seq<0> type; };
+
+//*****************************************************************************
+//class CConstTable
+//Purpose:
+//  A function table as a constant expression, the flat entries of _Table are
+//  _Entry<0>::fn() ~ _Entry<_N-1>::fn(). an object defined from table() is 
+//  constant initialized, it lives in read only data.
+//*****************************************************************************
+template <class _Table, template<int> class _Entry, int _N>
+class CConstTable {
+	template<int... I>
+	static constexpr _Table make( et_index_seq<I...> ) {
+		return _Table{ { _Entry<I>::fn()... } };
+	}
+public:
+	static constexpr _Table table() {
+		return make( typename et_make_index_seq<_N>::type() );
+	}
+};
+
+//*****************************************************************************
+//class CRecoverTable
+//Purpose:
+//  The recover table [numDisk-3][miss1][miss2] of the unrolled kernels of lane 
+//  _LT, miss1<=miss2. all 0 if the lane does not fit the Prime's group, or the 
+//  Prime is above eUnrollPrimeLimit. disk numbers above _LT::ePrime+2 are 0.
+//*****************************************************************************
+template <class _LT, bool _Fit = (sizeof(T)==8 || _LT::eWidth==1) && (_LT::ePrime-1)%_LT::eWidth==0 
+	&& (int)_LT::ePrime<=(int)raid6_config_tag::eUnrollPrimeLimit>
+class CRecoverTable {
+	enum { eDim = eImpDiskNum, eFnInstNum = eImpDiskNum<_LT::ePrime+2? eImpDiskNum : _LT::ePrime+2 };
+	template<int ND, int M1, int M2, bool _Set = (ND<=(int)eFnInstNum && M1<=M2 && M2<ND)>
+	class et_fn { public:
+		static constexpr R6RecoverFnType fn() { 
+			return _LT::template engine<ND>::type::template traits<M1, M2, 0>::imp::run; 
+		}
+	};
+	template<int ND, int M1, int M2>
+	class et_fn<ND, M1, M2, false> { public:
+		static constexpr R6RecoverFnType fn() { return 0; }
+	};
+	template<int I>
+	class et_entry : public et_fn<I/(eDim*eDim)+3, I/eDim%eDim, I%eDim> {};
+public:
+	static constexpr SRaid6RecoverTable table() {
+		return CConstTable< SRaid6RecoverTable, et_entry, (eDim-2)*eDim*eDim >::table();
+	}
+};//end CRecoverTable
+template <class _LT>
+class CRecoverTable<_LT, false> { public:
+	static constexpr SRaid6RecoverTable table() { return SRaid6RecoverTable(); }
+};
+
+//*****************************************************************************
+//class CLoopVectorTable
+//Purpose:
+//  The loop recover kernel of lane _LT, 0 if the lane does not fit the Prime's 
+//  group. unlike CRecoverTable it serves every Prime, the code size is one kernel.
+//*****************************************************************************
+template <class _LT, bool _Fit = sizeof(T)==8 && (_LT::ePrime-1)%_LT::eWidth==0>
+class CLoopVectorTable { public:
+	static constexpr R6LoopRecoverFnType fn() { return CLoopVectorRaid6<_LT>::recover; }
+};
+template <class _LT>
+class CLoopVectorTable<_LT, false> { public:
+	static constexpr R6LoopRecoverFnType fn() { return 0; }
+};
+
+//*****************************************************************************
+//class CUpdateTable
+//Purpose:
+//  The update table [mode][dataIdx] of Prime _P, dataIdx 2 ~ min(eImpDiskNum,_P+2)-1
+//*****************************************************************************
+template <int _P, bool _Unroll = (_P<=(int)raid6_config_tag::eUnrollPrimeLimit)>
+class CUpdateTable {
+	enum { eDim = eImpDiskNum, eFnInstNum = eImpDiskNum<_P+2? eImpDiskNum : _P+2 };
+	template<int M, int D, bool _Set = (D>=2 && D<(int)eFnInstNum)>
+	class et_fn { public:
+		static constexpr R6UpdateFnType fn() { 
+			return CGenericUpdate<D, _P>::template update_x<M==eUpdateDiff>::run; 
+		}
+	};
+	template<int M, int D>
+	class et_fn<M, D, false> { public:
+		static constexpr R6UpdateFnType fn() { return 0; }
+	};
+	template<int I>
+	class et_entry : public et_fn<I/eDim, I%eDim> {};
+public:
+	static constexpr SRaid6UpdateTable table() {
+		return CConstTable< SRaid6UpdateTable, et_entry, eUpdateModeNum*eDim >::table();
+	}
+};//end CUpdateTable
+template <int _P>
+class CUpdateTable<_P, false> { public:
+	static constexpr SRaid6UpdateTable table() { return SRaid6UpdateTable(); }
+};
+
+//*****************************************************************************
+//class CVerifyTable
+//Purpose:
+//  The verify table [numDisk-3] of Prime _P
+//*****************************************************************************
+template <int _P, bool _Unroll = (_P<=(int)raid6_config_tag::eUnrollPrimeLimit)>
+class CVerifyTable {
+	enum { eFnInstNum = eImpDiskNum<_P+2? eImpDiskNum : _P+2 };
+	template<int ND, bool _Set = (ND<=(int)eFnInstNum)>
+	class et_fn { public:
+		static constexpr R6VerifyFnType fn() { return CGenericRaid6<ND, _P>::verify_dr::run; }
+	};
+	template<int ND>
+	class et_fn<ND, false> { public:
+		static constexpr R6VerifyFnType fn() { return 0; }
+	};
+	template<int I>
+	class et_entry : public et_fn<I+3> {};
+public:
+	static constexpr SRaid6VerifyTable table() {
+		return CConstTable< SRaid6VerifyTable, et_entry, eImpDiskNum-2 >::table();
+	}
+};//end CVerifyTable
+template <int _P>
+class CVerifyTable<_P, false> { public:
+	static constexpr SRaid6VerifyTable table() { return SRaid6VerifyTable(); }
+};
+
+//*****************************************************************************
+//class CEncodeCrcTable
+//Purpose:
+//  The fused encode and crc table [numDisk-3] of Prime _P, crc policy _CRC
+//  provides: static unsigned update(unsigned crc, T v)
+//*****************************************************************************
+template <int _P, class _CRC, bool _Unroll = (_P<=(int)raid6_config_tag::eUnrollPrimeLimit)>
+class CEncodeCrcTable {
+	enum { eFnInstNum = eImpDiskNum<_P+2? eImpDiskNum : _P+2 };
+	template<int ND, bool _Set = (ND<=(int)eFnInstNum)>
+	class et_fn { public:
+		static constexpr R6CrcFnType fn() { return CGenericRaid6<ND, _P>::template encode_crc<_CRC>::run; }
+	};
+	template<int ND>
+	class et_fn<ND, false> { public:
+		static constexpr R6CrcFnType fn() { return 0; }
+	};
+	template<int I>
+	class et_entry : public et_fn<I+3> {};
+public:
+	static constexpr SRaid6CrcTable table() {
+		return CConstTable< SRaid6CrcTable, et_entry, eImpDiskNum-2 >::table();
+	}
+};//end CEncodeCrcTable
+template <int _P, class _CRC>
+class CEncodeCrcTable<_P, _CRC, false> { public:
+	static constexpr SRaid6CrcTable table() { return SRaid6CrcTable(); }
+};
+
+//recover tables of each kernel unit, [prime], all 0 for a prime the unit could not serve 
+//or if the unit is not compiled in.
+extern const SRaid6RecoverTable gRecoverFnSetScalar[ePrimeNum];
+extern const SRaid6RecoverTable gRecoverFnSetSSE2[ePrimeNum];
+extern const SRaid6RecoverTable gRecoverFnSetAVX2[ePrimeNum];
+extern const SRaid6RecoverTable gRecoverFnSetAVX512[ePrimeNum];
+
+//loop recover kernels of each kernel unit, [prime], 0 as above
+extern const R6LoopRecoverFnType gLoopRecoverFnSetScalar[ePrimeNum];
+extern const R6LoopRecoverFnType gLoopRecoverFnSetSSE2[ePrimeNum];
+extern const R6LoopRecoverFnType gLoopRecoverFnSetAVX2[ePrimeNum];
+extern const R6LoopRecoverFnType gLoopRecoverFnSetAVX512[ePrimeNum];
+
+//crc32c unit, the fused kernels [prime] and the blocks function, all 0 if not compiled in.
+extern const SRaid6CrcTable gEncodeCrcFnSetSSE42[ePrimeNum];
+R6CrcBlocksFnType get_crc_blocks_sse42();
+
+}//end namespace raid6
+#endif//_RAID6_ENGINE_HPP_INCLUDE_
@@ -0,0 +1,134 @@
+/***
+*raid6_gf.hpp - the P+Q Reed-Solomon engine templates
+*
+*       Copyright (c) Bingle	All rights reserved.
+*
+*Purpose:
+*       This file contains the GF(2^8) tables and the lane generic recover kernel
+*       of the P+Q code used by linux md raid6, see CRaid6RS.
+*
+*Author:
+*		Bingle(BinaryBB@hotmail.com)
+****/
+
+#ifndef _RAID6_GF_HPP_INCLUDE_
+#define _RAID6_GF_HPP_INCLUDE_
+
+#include <string.h>
+#include "raid6.hpp"
+
+namespace raid6{
+
+	//GF(2^8) of polynomial 0x11d and generator 2, as linux md
+	struct SGfTables
+	{
+		unsigned char exp[512];					//exp[i] = 2^i, doubled so a sum of two logs needs no mod
+		unsigned char log[256];					//log[0] not used
+		unsigned char nib[256][32];				//c*x of the low nibble x 0~15, then of the high nibble x<<4
+	};
+	extern SGfTables gGf;						//filled by CRaid6RS before any kernel runs
+
+	typedef int ( *R6GfRecoverFnType )(unsigned char** block, size_t numBytes, int numDisk, int miss1, int miss2);
+
+	//recover kernels of each kernel unit, 0 if not compiled in
+	extern const R6GfRecoverFnType gGfRecoverFnSSE2;
+	extern const R6GfRecoverFnType gGfRecoverFnAVX2;
+
+//*****************************************************************************
+//class CGfRaid6: the P+Q recover kernel on lanes.
+//Purpose:
+//  Recover any two members of a P+Q stripe. P (eRowIdx) is the xor of the data,
+//  Q (eDiaIdx) is the sum of g^z * data z, z = disk-2, every byte on its own.
+//Template arguements naming:
+//  _GT:    gf lane type, provides:
+//            type, eBytes                  vector of eBytes bytes
+//            zero(), vxor(a,b)
+//            load(p), store(p,v)           unaligned load/store
+//            mul2(v)                       every byte times g
+//            mulc(v, nib)                  every byte times c, nib = gGf.nib[c]
+//Comment:
+//  numBytes should be a multiple of eBytes. the stripe runs eChunk bytes of
+//  every disk at a time, the second pass of a missing pair reads them in cache.
+//*****************************************************************************
+template <class _GT>
+class CGfRaid6{
+public:
+	typedef typename _GT::type lane_t;
+	typedef unsigned char u8;
+	enum { eW = _GT::eBytes, eChunk = 4096 };
+private:
+	//p = seedP ^ xor of the data, q = seedQ ^ sum of g^z data z, skipping disks s1, s2.
+	//the seeds may be 0, an output 0 is not stored.
+	static inline void syndrome(u8** b, size_t off, size_t n, int nd, int s1, int s2,
+		const u8* seedP, const u8* seedQ, u8* outP, u8* outQ) {
+		int wantQ = outQ!=0;
+		for(size_t o=0; o<n; o+=eW) {
+			lane_t p = _GT::zero(), q = _GT::zero();
+			for(int d=nd-1; d>=2; --d) {
+				if(wantQ) q = _GT::mul2(q);
+				if(d==s1 || d==s2) continue;
+				lane_t v = _GT::load( b[d] + off + o );
+				p = _GT::vxor(p, v);
+				q = _GT::vxor(q, v);
+			}
+			if(seedP) p = _GT::vxor( p, _GT::load(seedP + o) );
+			if(seedQ) q = _GT::vxor( q, _GT::load(seedQ + o) );
+			if(outP) _GT::store(outP + o, p);
+			if(outQ) _GT::store(outQ + o, q);
+		}
+	}
+	static inline u8 gf_inv(u8 c) {
+		return gGf.exp[ 255 - gGf.log[c] ];
+	}
+public:
+	//recover missing m1, m2 (m1<=m2) of nd disks, n bytes each
+	static int recover(u8** b, size_t n, int nd, int m1, int m2) {
+		u8 tp[eChunk], tq[eChunk];
+		for(size_t off=0; off<n; off+=eChunk) {
+			size_t len = n-off<eChunk? n-off : (size_t)eChunk;
+			u8* pq = b[eDiaIdx] + off;
+			u8* pp = b[eRowIdx] + off;
+			if(m1==eDiaIdx && m2==eDiaIdx) {
+				syndrome(b, off, len, nd, -1, -1, 0, 0, 0, pq);
+			}
+			else if(m1==eRowIdx && m2==eRowIdx) {
+				syndrome(b, off, len, nd, -1, -1, 0, 0, pp, 0);
+			}
+			else if(m1==eDiaIdx && m2==eRowIdx) {
+				syndrome(b, off, len, nd, -1, -1, 0, 0, pp, pq);
+			}
+			else if(m1==m2 || m1==eDiaIdx) {	//data from P, then Q if it is missing too
+				syndrome(b, off, len, nd, m2, m2, pp, 0, b[m2] + off, 0);
+				if(m1==eDiaIdx) syndrome(b, off, len, nd, -1, -1, 0, 0, 0, pq);
+			}
+			else if(m1==eRowIdx) {	//data from Q, g^z x = Q ^ Q without x, then P
+				const u8* nib = gGf.nib[ gGf.exp[255-(m2-2)] ];
+				u8* px = b[m2] + off;
+				syndrome(b, off, len, nd, m2, m2, 0, pq, 0, tq);
+				for(size_t o=0; o<len; o+=eW) {
+					_GT::store( px + o, _GT::mulc( _GT::load(tq + o), nib ) );
+				}
+				syndrome(b, off, len, nd, -1, -1, 0, 0, pp, 0);
+			}
+			else {	//two data, dp = x^y, dq = g^a x ^ g^b y: y = (g^a dp ^ dq)/(g^a ^ g^b)
+				int za = m1-2, zb = m2-2;
+				u8 ga = gGf.exp[za], gb = gGf.exp[zb];
+				const u8* nibP = gGf.nib[ gf_inv( gGf.exp[zb-za] ^ 1 ) ];
+				const u8* nibQ = gGf.nib[ gf_inv( ga ^ gb ) ];
+				u8* px = b[m1] + off;
+				u8* py = b[m2] + off;
+				syndrome(b, off, len, nd, m1, m2, pp, pq, tp, tq);
+				for(size_t o=0; o<len; o+=eW) {
+					lane_t dp = _GT::load(tp + o);
+					lane_t y  = _GT::vxor( _GT::mulc(dp, nibP), _GT::mulc( _GT::load(tq + o), nibQ ) );
+					_GT::store( py + o, y );
+					_GT::store( px + o, _GT::vxor(dp, y) );
+				}
+			}
+		}
+		return errOK;
+	}
+};//gf raid6
+
+}//end namespace raid6
+#endif//_RAID6_GF_HPP_INCLUDE_
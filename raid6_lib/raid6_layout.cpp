@@ -0,0 +1,173 @@
+/***
+*raid6_layout.cpp - rotating parity layout for raid6 library
+*
+*       Copyright (c) Bingle	All rights reserved.
+*
+*Purpose:
+*       This file contains the implementation of the rotating parity layout.
+*
+*Author:
+*		Bingle(BinaryBB@hotmail.com)
+****/
+
+#include "raid6_layout.hpp"
+
+namespace raid6{
+
+CRaid6Layout::CRaid6Layout()
+	: mNumMember(0), mLayout(eLayoutLeftSymmetric), mChunkBytes(0)
+{
+}
+
+CRaid6Layout::~CRaid6Layout() {
+}
+
+//the tables of the numMember stripes the layout repeats over
+int CRaid6Layout::set(int numMember, int layout, size_t chunkBytes) {
+	if(numMember<3 || numMember>eLimitDiskNum )	return errInvalidDiskNum;
+	if(layout<0 || layout>=eLayoutNum || chunkBytes==0 )	return errInvalidLayout;
+	int n = numMember;
+	mMember.resize( (size_t)n*n );
+	mBlock.resize( (size_t)n*n );
+	for(int s=0; s<n; ++s) {
+		int* member = &mMember[ (size_t)s*n ];
+		int left = layout==eLayoutLeftAsymmetric || layout==eLayoutLeftSymmetric;
+		int row  = left? n-1-s : s;
+		int dia  = (row+1)%n;
+		member[eRowIdx] = row;
+		member[eDiaIdx] = dia;
+		if(layout==eLayoutLeftSymmetric || layout==eLayoutRightSymmetric) {
+			for(int i=2; i<n; ++i) {
+				member[i] = (dia+i-1)%n;
+			}
+		}
+		else {
+			for(int m=0, i=2; m<n; ++m) {
+				if(m!=row && m!=dia) member[i++] = m;
+			}
+		}
+		for(int i=0; i<n; ++i) {
+			mBlock[ (size_t)s*n + member[i] ] = i;
+		}
+	}
+	mNumMember  = numMember;
+	mLayout     = layout;
+	mChunkBytes = chunkBytes;
+	return errOK;
+}
+
+int CRaid6Layout::get_num_member() const {
+	return mNumMember;
+}
+
+int CRaid6Layout::get_layout() const {
+	return mLayout;
+}
+
+size_t CRaid6Layout::get_chunk_bytes() const {
+	return mChunkBytes;
+}
+
+unsigned long long CRaid6Layout::get_stripe_data_bytes() const {
+	return (unsigned long long)(mNumMember-2)*mChunkBytes;
+}
+
+int CRaid6Layout::get_member(unsigned long long stripe, int blockIdx) const {
+	if(blockIdx<0 || blockIdx>=mNumMember) return -1;
+	return mMember[ (size_t)(stripe%mNumMember)*mNumMember + blockIdx ];
+}
+
+int CRaid6Layout::get_block_idx(unsigned long long stripe, int member) const {
+	if(member<0 || member>=mNumMember) return -1;
+	return mBlock[ (size_t)(stripe%mNumMember)*mNumMember + member ];
+}
+
+//*****************************************************************************
+//Function:
+//		split a logical byte range of the array into its chunks.
+//Param:
+//		offset, length:	the logical byte range, the data of the array in order.
+//		ext:		out: the first maxExt chunk pieces, in logical order. may be 0.
+//		maxExt:		entries of ext.
+//		numExt:		out: number of pieces of the whole range, may be 0.
+//Return:
+//		return errOK if ext holds the whole range, errFAIL if it is short,
+//		otherwise, return error code
+//*****************************************************************************
+int CRaid6Layout::map(unsigned long long offset, size_t length, SRaid6Extent* ext, int maxExt, int* numExt) const {
+	if(!mNumMember) return errInvalidLayout;
+	unsigned long long stripeBytes = get_stripe_data_bytes();
+	unsigned long long stripe = offset/stripeBytes;
+	size_t within = (size_t)(offset%stripeBytes);
+	int count = 0;
+	while(length) {
+		int dataIdx = (int)(within/mChunkBytes);
+		size_t off  = within%mChunkBytes;
+		size_t n    = mChunkBytes-off<length? mChunkBytes-off : length;
+		if(ext && count<maxExt) {
+			SRaid6Extent& e = ext[count];
+			e.stripe       = stripe;
+			e.blockIdx     = dataIdx+2;
+			e.member       = get_member(stripe, e.blockIdx);
+			e.offset       = off;
+			e.numBytes     = n;
+			e.memberOffset = stripe*mChunkBytes + off;
+		}
+		++count;
+		length -= n;
+		within += n;
+		if(within==stripeBytes) {
+			within = 0;
+			++stripe;
+		}
+	}
+	if(numExt) *numExt = count;
+	return count<=maxExt || !ext? errOK : errFAIL;
+}
+
+//*****************************************************************************
+//Function:
+//		the block array of a stripe from its member chunks.
+//Param:
+//		stripe:		stripe number.
+//		member:		chunk of the stripe on each member, index 0~numMember-1.
+//		block:		out: numMember entries, as recover() takes them,
+//					block[eDiaIdx], block[eRowIdx] the parities.
+//Return:
+//		return errOK if success, otherwise, return error code
+//*****************************************************************************
+int CRaid6Layout::build_block(unsigned long long stripe, T* const* member, T** block) const {
+	if(!mNumMember) return errInvalidLayout;
+	if(!member || !block) return errNullBlockPointer;
+	const int* order = &mMember[ (size_t)(stripe%mNumMember)*mNumMember ];
+	for(int i=0; i<mNumMember; ++i) {
+		block[i] = member[ order[i] ];
+	}
+	return errOK;
+}
+
+//*****************************************************************************
+//Function:
+//		recover the chunks of one stripe on two missing members.
+//Param:
+//		engine:		the engine run, its prime should serve numMember disks.
+//		member:		chunk of the stripe on each member, as build_block().
+//		numBytes:	bytes of each chunk recovered, as recover().
+//		missingMember1, missingMember2:	member index of the missing disks,
+//					the same one if one is missing. the parity members of the
+//					stripe missing encode it.
+//Return:
+//		return errOK if success, otherwise, return error code
+//*****************************************************************************
+int CRaid6Layout::recover(CRaid6& engine, unsigned long long stripe, T* const* member, size_t numBytes,
+	int missingMember1, int missingMember2) const {
+	T* block[eLimitDiskNum+1];
+	int result = build_block(stripe, member, block);
+	if(errOK!=result) return result;
+	int miss1 = get_block_idx(stripe, missingMember1);
+	int miss2 = get_block_idx(stripe, missingMember2);
+	if(miss1<0 || miss2<0) return errInvalidMissIdx;
+	return engine.recover(block, numBytes, mNumMember, miss1, miss2);
+}
+
+}//end namespace raid6
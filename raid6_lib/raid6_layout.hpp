@@ -0,0 +1,88 @@
+/***
+*raid6_layout.hpp - rotating parity layout for raid6 library
+*
+*       Copyright (c) Bingle	All rights reserved.
+*
+*Purpose:
+*       This file contains the stripe layout of an array whose parities rotate
+*       over the members: logical byte ranges to member chunks, and the block
+*       arrays of a stripe in the order recover() takes them.
+*
+*Author:
+*		Bingle(BinaryBB@hotmail.com)
+****/
+
+#ifndef _RAID6_LAYOUT_HPP_INCLUDE_
+#define _RAID6_LAYOUT_HPP_INCLUDE_
+
+#include <vector>
+#include "raid6.hpp"
+
+namespace raid6{
+
+	//where the parities of a stripe go, the names and placement of linux md. stripe s of
+	//n members has the row parity on member n-1-s%n (left) or s%n (right), the diagonal
+	//parity on the member after it. the data chunks fill the other members from member 0
+	//(asymmetric), or from the one after the diagonal parity, wrapping round (symmetric).
+	enum EnumLayout
+	{
+		eLayoutLeftAsymmetric  = 0,
+		eLayoutRightAsymmetric = 1,
+		eLayoutLeftSymmetric   = 2,				//md's default
+		eLayoutRightSymmetric  = 3,
+		eLayoutNum             = 4,
+	};
+
+	//the part of a logical byte range in one chunk
+	struct SRaid6Extent
+	{
+		unsigned long long	stripe;
+		int					member;				//member disk holding it
+		int					blockIdx;			//index of the chunk in the stripe's block array, 2~ for data
+		size_t				offset;				//byte offset in the chunk
+		size_t				numBytes;
+		unsigned long long	memberOffset;		//byte offset in the member, stripe*chunkBytes + offset
+	};
+
+	//*****************************************************************************
+	// class CRaid6Layout
+	// maps the array's logical bytes to (stripe, member, offset), and the member
+	// chunks of a stripe to the block array of recover(). a stripe is one chunk
+	// of every member, stripe s at byte s*chunkBytes of each. the layout repeats
+	// every numMember stripes, both ways of it are tables built by set(), the 
+	// calls after allocate nothing.
+	//*****************************************************************************
+	class CRaid6Layout{
+	private:
+		int					mNumMember;
+		int					mLayout;			//EnumLayout
+		size_t				mChunkBytes;
+		std::vector<int>	mMember;			//[phase*numMember + block index]: member of the block
+		std::vector<int>	mBlock;				//[phase*numMember + member]: block index of the member
+
+	public:
+		CRaid6Layout();
+		~CRaid6Layout();
+
+	public:
+		int set(int numMember, int layout, size_t chunkBytes);
+		int get_num_member() const;
+		int get_layout() const;
+		size_t get_chunk_bytes() const;
+		unsigned long long get_stripe_data_bytes() const;	//logical bytes of a stripe, (numMember-2)*chunkBytes
+
+		int get_member(unsigned long long stripe, int blockIdx) const;		//-1 if out of range
+		int get_block_idx(unsigned long long stripe, int member) const;		//-1 if out of range
+		int map(unsigned long long offset, size_t length, SRaid6Extent* ext, int maxExt, int* numExt) const;
+		int build_block(unsigned long long stripe, T* const* member, T** block) const;
+		int recover(CRaid6& engine, unsigned long long stripe, T* const* member, size_t numBytes, 
+			int missingMember1, int missingMember2) const;
+
+	private:
+		CRaid6Layout(const CRaid6Layout&);
+		CRaid6Layout& operator=(const CRaid6Layout&);
+	};//end CRaid6Layout
+
+}//end namespace
+
+#endif//_RAID6_LAYOUT_HPP_INCLUDE_
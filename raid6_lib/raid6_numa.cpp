@@ -0,0 +1,192 @@
+/***
+*raid6_numa.cpp - numa placement for raid6 library
+*
+*       Copyright (c) Bingle	All rights reserved.
+*
+*Purpose:
+*       This file contains the implementation of the numa helpers.
+*
+*Author:
+*		Bingle(BinaryBB@hotmail.com)
+****/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE						//sched_setaffinity, sched_getcpu
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <mutex>
+#include "raid6.hpp"
+#include "raid6_numa.hpp"
+#ifdef LIB_GCC4_1_OPTIMIZE_ENABLED
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace raid6{
+
+std::vector< std::vector<int> > CRaid6Numa::msNodeCpus;
+std::vector<int> CRaid6Numa::msCpuNode;
+std::vector<int> CRaid6Numa::msNodeId;
+static std::once_flag gNumaOnce;
+
+#ifdef LIB_GCC4_1_OPTIMIZE_ENABLED
+//memory policy of mbind(), as linux/mempolicy.h
+enum { eMpolPreferred = 1, eMaxOsNode = 1024 };
+
+//a /sys cpu list as "0-3,8-11"
+static void parse_cpu_list(const char* s, std::vector<int>& cpus) {
+	while(*s>='0' && *s<='9') {
+		char* e;
+		int first = (int)strtol(s, &e, 10);
+		int last  = first;
+		if('-'==*e) last = (int)strtol(e+1, &e, 10);
+		for(int c=first; c<=last; ++c) {
+			cpus.push_back(c);
+		}
+		s = ','==*e? e+1 : e;
+	}
+}
+#endif
+
+//nodes with cpus, in node number order. one node of all cpus if /sys has none
+void CRaid6Numa::init_once() {
+#ifdef LIB_GCC4_1_OPTIMIZE_ENABLED
+	char line[4096];
+	std::vector<int> online;
+	FILE* f = fopen("/sys/devices/system/node/online", "r");
+	if(f) {
+		if( fgets(line, sizeof(line), f) ) parse_cpu_list(line, online);
+		fclose(f);
+	}
+	for(size_t k=0; k<online.size(); ++k) {
+		char path[64];
+		snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", online[k]);
+		std::vector<int> cpus;
+		f = fopen(path, "r");
+		if(!f) continue;
+		if( fgets(line, sizeof(line), f) ) parse_cpu_list(line, cpus);
+		fclose(f);
+		if( cpus.empty() ) continue;			//memory only node
+		for(size_t i=0; i<cpus.size(); ++i) {
+			if( (size_t)cpus[i]>=msCpuNode.size() ) msCpuNode.resize(cpus[i]+1, 0);
+			msCpuNode[ cpus[i] ] = (int)msNodeCpus.size();
+		}
+		msNodeCpus.push_back(cpus);
+		msNodeId.push_back(online[k]);
+	}
+#endif
+	if( msNodeCpus.empty() ) {
+		msNodeCpus.resize(1);
+		msNodeId.assign(1, 0);
+	}
+}
+
+//our node of an os node number, -1 for a node without cpus
+int CRaid6Numa::to_node(int osNode) {
+	for(size_t n=0; n<msNodeId.size(); ++n) {
+		if(msNodeId[n]==osNode) return (int)n;
+	}
+	return -1;
+}
+
+int CRaid6Numa::get_node_num() {
+	std::call_once(gNumaOnce, init_once);
+	return (int)msNodeCpus.size();
+}
+
+int CRaid6Numa::get_cpu_node(int cpu) {
+	std::call_once(gNumaOnce, init_once);
+	return cpu>=0 && cpu<(int)msCpuNode.size()? msCpuNode[cpu] : 0;
+}
+
+int CRaid6Numa::get_current_node() {
+#ifdef LIB_GCC4_1_OPTIMIZE_ENABLED
+	return get_cpu_node( sched_getcpu() );
+#else
+	return 0;
+#endif
+}
+
+void* CRaid6Numa::alloc(size_t numBytes, int node) {
+	std::call_once(gNumaOnce, init_once);
+#ifdef LIB_GCC4_1_OPTIMIZE_ENABLED
+	void* p = mmap(0, numBytes, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+	if(MAP_FAILED==p) return 0;
+	//the pages come when first touched, from node if it has them
+	if(node>=0 && node<(int)msNodeCpus.size() && msNodeCpus.size()>1) {
+		const int bits = 8*sizeof(unsigned long);
+		unsigned long mask[eMaxOsNode/(8*sizeof(unsigned long))];
+		memset(mask, 0, sizeof(mask));
+		int osNode = msNodeId[node];
+		if(osNode<eMaxOsNode) {
+			mask[osNode/bits] |= 1UL<<(osNode%bits);
+			syscall(SYS_mbind, p, numBytes, (int)eMpolPreferred, mask, (unsigned long)eMaxOsNode, 0);
+		}
+	}
+	return p;
+#else
+	(void)node;
+	return calloc(1, numBytes);
+#endif
+}
+
+void CRaid6Numa::release(void* ptr, size_t numBytes) {
+	if(!ptr) return;
+#ifdef LIB_GCC4_1_OPTIMIZE_ENABLED
+	munmap(ptr, numBytes);
+#else
+	(void)numBytes;
+	free(ptr);
+#endif
+}
+
+int CRaid6Numa::get_mem_node(const void* const* addr, int count, int* node) {
+	std::call_once(gNumaOnce, init_once);
+	if(count<=0) return errOK;
+	if(!addr || !node) return errNullBlockPointer;
+	for(int i=0; i<count; ++i) {
+		node[i] = msNodeCpus.size()>1? -1 : 0;
+	}
+#ifdef LIB_GCC4_1_OPTIMIZE_ENABLED
+	if(msNodeCpus.size()<=1) return errOK;
+	//move_pages() without target nodes reports the node of each page, os numbering
+	long page = sysconf(_SC_PAGESIZE);
+	std::vector<void*> pages(count);
+	for(int i=0; i<count; ++i) {
+		pages[i] = (void*)( (size_t)addr[i] & ~(size_t)(page-1) );
+	}
+	if( 0!=syscall(SYS_move_pages, 0, (unsigned long)count, &pages[0], (const int*)0, node, 0) ) {
+		for(int i=0; i<count; ++i) node[i] = -1;
+		return errFAIL;
+	}
+	for(int i=0; i<count; ++i) {
+		if(node[i]>=0) node[i] = to_node(node[i]);
+	}
+#endif
+	return errOK;
+}
+
+int CRaid6Numa::bind_thread(int node) {
+	std::call_once(gNumaOnce, init_once);
+	if(node>=(int)msNodeCpus.size()) return errFAIL;
+#ifdef LIB_GCC4_1_OPTIMIZE_ENABLED
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for(int n=0; n<(int)msNodeCpus.size(); ++n) {
+		if(node>=0 && n!=node) continue;
+		for(size_t i=0; i<msNodeCpus[n].size(); ++i) {
+			CPU_SET(msNodeCpus[n][i], &set);
+		}
+	}
+	if( CPU_COUNT(&set)==0 ) return errOK;	//no cpu list, leave it as it is
+	return 0==sched_setaffinity(0, sizeof(set), &set)? errOK : errFAIL;
+#else
+	return errOK;
+#endif
+}
+
+}//end namespace raid6
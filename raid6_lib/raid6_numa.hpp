@@ -0,0 +1,55 @@
+/***
+*raid6_numa.hpp - numa placement for raid6 library
+*
+*       Copyright (c) Bingle	All rights reserved.
+*
+*Purpose:
+*       This file contains the numa helpers: the nodes and their cpus, buffers
+*       placed on a node, the node a buffer's pages are on, and threads bound to
+*       a node's cpus. One node and no binding where the os gives no numa info.
+*
+*Author:
+*		Bingle(BinaryBB@hotmail.com)
+****/
+
+#ifndef _RAID6_NUMA_HPP_INCLUDE_
+#define _RAID6_NUMA_HPP_INCLUDE_
+
+#include <stddef.h>
+#include <vector>
+
+namespace raid6{
+
+	//*****************************************************************************
+	// class CRaid6Numa
+	// the node list and the cpus of each are read once, on the first call. linux
+	// only, through the system calls and /sys, no libnuma needed.
+	//*****************************************************************************
+	class CRaid6Numa{
+	private:
+		static std::vector< std::vector<int> >	msNodeCpus;	//[node]: its cpus
+		static std::vector<int>					msCpuNode;	//[cpu]: its node
+		static std::vector<int>					msNodeId;	//[node]: the os node number
+
+	public:
+		static int get_node_num();				//nodes with cpus, 1 if no numa info
+		static int get_cpu_node(int cpu);		//0 if not known
+		static int get_current_node();			//node of the cpu the caller runs on now
+
+		//page aligned zeroed buffer, its pages preferably on node, node -1 as the 
+		//first touch goes. 0 if out of memory
+		static void* alloc(size_t numBytes, int node);
+		static void  release(void* ptr, size_t numBytes);
+		//node of the page of each addr, -1 if not known or not touched yet. one call for all
+		static int get_mem_node(const void* const* addr, int count, int* node);
+		//the calling thread to the cpus of node, node -1 to all cpus. threads it starts after inherit it
+		static int bind_thread(int node);
+
+	private:
+		static void init_once();
+		static int  to_node(int osNode);
+	};//end CRaid6Numa
+
+}//end namespace
+
+#endif//_RAID6_NUMA_HPP_INCLUDE_
@@ -0,0 +1,183 @@
+/***
+*raid6_pool.cpp - worker thread pool for raid6 library
+*
+*       Copyright (c) Bingle	All rights reserved.
+*
+*Purpose:
+*       This file contains the implementation of the work stealing thread pool.
+*
+*Author:
+*		Bingle(BinaryBB@hotmail.com)
+****/
+
+#include "raid6.hpp"
+#include "raid6_pool.hpp"
+#include "raid6_numa.hpp"
+
+namespace raid6{
+
+CRaid6Pool::CRaid6Pool(int numThread, int numa)
+	: mNumNode(numa? CRaid6Numa::get_node_num() : 1), mStop(false)
+{
+	if(numThread<1) numThread = 1;
+	mQueued = new std::atomic<int>[mNumNode+1];
+	for(int n=0; n<=mNumNode; ++n) {
+		mQueued[n] = 0;
+	}
+	for(int i=0; i<numThread; ++i) {
+		mWorkers.push_back( new SWorker );
+		mWorkers[i]->node = numa? i%mNumNode : -1;
+	}
+	for(int i=0; i<numThread; ++i) {
+		mWorkers[i]->thread = std::thread(&CRaid6Pool::worker_main, this, i);
+	}
+}
+
+CRaid6Pool::~CRaid6Pool() {
+	{
+		std::lock_guard<std::mutex> lk(mIdleLock);
+		mStop = true;
+	}
+	mIdle.notify_all();
+	//join all before freeing any, a running worker may still look into the others' queues
+	for(size_t i=0; i<mWorkers.size(); ++i) {
+		mWorkers[i]->thread.join();
+	}
+	for(size_t i=0; i<mWorkers.size(); ++i) {
+		delete mWorkers[i];
+	}
+	delete[] mQueued;
+}
+
+int CRaid6Pool::get_thread_num() const {
+	return (int)mWorkers.size();
+}
+
+int CRaid6Pool::is_numa() const {
+	return mWorkers[0]->node>=0;
+}
+
+int CRaid6Pool::parallel_for(R6TaskFnType fn, void* arg, int numTask, const int* taskNode) {
+	if(numTask<=0) return errOK;
+	SBatch batch;
+	batch.pending = numTask;
+
+	int numWorker = (int)mWorkers.size();
+	if(!taskNode || !is_numa()) {
+		queue_run(-1, fn, arg, 0, numTask, &batch);
+	}
+	else {
+		//the tasks of each node to its workers, the ones of any node or of a node 
+		//without workers last, at the back where the other nodes steal from
+		std::vector<int> idx(numTask);
+		int count = 0;
+		for(int n=0; n<mNumNode && n<numWorker; ++n) {
+			int first = count;
+			for(int i=0; i<numTask; ++i) {
+				if(taskNode[i]==n) idx[count++] = i;
+			}
+			queue_run(n, fn, arg, &idx[first], count-first, &batch);
+		}
+		int first = count;
+		for(int i=0; i<numTask; ++i) {
+			if(taskNode[i]<0 || taskNode[i]>=mNumNode || taskNode[i]>=numWorker) idx[count++] = i;
+		}
+		queue_run(-1, fn, arg, &idx[first], count-first, &batch);
+	}
+	mIdle.notify_all();
+
+	//help until nothing left to steal, then wait the tasks still running
+	STask task;
+	int node = is_numa()? CRaid6Numa::get_current_node() : -1;
+	while( steal(-1, node, task) ) {
+		execute(task);
+	}
+	std::unique_lock<std::mutex> lk(batch.lock);
+	while(batch.pending>0) {
+		batch.done.wait(lk);
+	}
+	return errOK;
+}
+
+//queue tasks idx[0]~idx[count-1], all i if idx 0, over the workers of node, all workers if -1
+void CRaid6Pool::queue_run(int node, R6TaskFnType fn, void* arg, const int* idx, int count, SBatch* batch) {
+	if(count<=0) return;
+	std::vector<int> worker;
+	for(int w=0; w<(int)mWorkers.size(); ++w) {
+		if(node<0 || mWorkers[w]->node==node) worker.push_back(w);
+	}
+	//contiguous runs keep neighbour tasks on one core, stealing balances the tail
+	int numWorker = (int)worker.size();
+	for(int w=0; w<numWorker; ++w) {
+		int first = (int)( (long long)count*w/numWorker );
+		int last  = (int)( (long long)count*(w+1)/numWorker );
+		if(first==last) continue;
+		SWorker* sw = mWorkers[ worker[w] ];
+		std::lock_guard<std::mutex> lk(sw->lock);
+		for(int i=first; i<last; ++i) {
+			STask task = {fn, arg, idx? idx[i] : i, node, batch};
+			sw->queue.push_back(task);
+		}
+	}
+	std::lock_guard<std::mutex> lk(mIdleLock);
+	mQueued[node+1] += count;
+}
+
+bool CRaid6Pool::pop(int self, STask& task) {
+	SWorker* w = mWorkers[self];
+	std::lock_guard<std::mutex> lk(w->lock);
+	if(w->queue.empty()) return false;
+	task = w->queue.front();
+	w->queue.pop_front();
+	--mQueued[task.node+1];
+	return true;
+}
+
+//a task of node or of any node from the back of another queue, node -1 takes any task
+bool CRaid6Pool::steal(int self, int node, STask& task) {
+	int numWorker = (int)mWorkers.size();
+	int start = self<0? 0 : self+1;
+	for(int i=0; i<numWorker; ++i) {
+		int victim = (start+i) % numWorker;
+		if(victim==self) continue;
+		SWorker* w = mWorkers[victim];
+		std::lock_guard<std::mutex> lk(w->lock);
+		if(w->queue.empty()) continue;
+		int taskNode = w->queue.back().node;
+		if(node>=0 && taskNode>=0 && taskNode!=node) continue;
+		task = w->queue.back();
+		w->queue.pop_back();
+		--mQueued[task.node+1];
+		return true;
+	}
+	return false;
+}
+
+void CRaid6Pool::execute(STask& task) {
+	task.fn(task.arg, task.idx);
+	//the submitter may free the batch as soon as it sees pending==0, so only touch it under the lock
+	std::lock_guard<std::mutex> lk(task.batch->lock);
+	if(--task.batch->pending==0) {
+		task.batch->done.notify_all();
+	}
+}
+
+void CRaid6Pool::worker_main(int self) {
+	int node = mWorkers[self]->node;
+	if(node>=0) CRaid6Numa::bind_thread(node);
+	STask task;
+	for(;;) {
+		if( pop(self, task) || steal(self, node, task) ) {
+			execute(task);
+			continue;
+		}
+		//sleep while nothing this worker may take is queued
+		std::unique_lock<std::mutex> lk(mIdleLock);
+		while( !mStop && mQueued[0]==0 && (node<0 || mQueued[node+1]==0) ) {
+			mIdle.wait(lk);
+		}
+		if(mStop) break;
+	}
+}
+
+}//end namespace raid6
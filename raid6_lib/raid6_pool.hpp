@@ -0,0 +1,90 @@
+/***
+*raid6_pool.hpp - worker thread pool for raid6 library
+*
+*       Copyright (c) Bingle	All rights reserved.
+*
+*Purpose:
+*       This file contains the work stealing thread pool the raid6 engine uses
+*       to spread independent (P-1)-row groups over cores.
+*
+*Author:
+*		Bingle(BinaryBB@hotmail.com)
+****/
+
+#ifndef _RAID6_POOL_HPP_INCLUDE_
+#define _RAID6_POOL_HPP_INCLUDE_
+
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+namespace raid6{
+
+	typedef void ( *R6TaskFnType )(void* arg, int taskIdx);
+
+	//*****************************************************************************
+	// class CRaid6Pool
+	// persistent workers, each owns a task deque. a batch is split into contiguous
+	// runs over the workers, a worker pops its own front and steals from the back
+	// of the others once it runs dry. the submitting thread helps until the batch
+	// is done.
+	// a numa pool pins worker i to the cpus of node i%nodes. a task tagged with a
+	// node goes to the workers of that node and is only stolen by them, so the
+	// work on a buffer stays on the cores local to its memory.
+	//*****************************************************************************
+	class CRaid6Pool{
+	private:
+		struct SBatch {
+			int						pending;	//tasks not finished, guarded by lock
+			std::mutex				lock;
+			std::condition_variable	done;
+		};
+		struct STask {
+			R6TaskFnType	fn;
+			void*			arg;
+			int				idx;
+			int				node;		//numa node the task runs on, -1 any
+			SBatch*			batch;
+		};
+		struct SWorker {
+			std::mutex			lock;
+			std::deque<STask>	queue;
+			std::thread			thread;
+			int					node;		//numa node pinned to, -1 not pinned
+		};
+
+		std::vector<SWorker*>	mWorkers;
+		std::mutex				mIdleLock;
+		std::condition_variable	mIdle;		//signaled when tasks queued or stopping
+		std::atomic<int>*		mQueued;	//[node+1]: tasks waiting in all queues, [0] the ones of any node
+		int						mNumNode;	//numa nodes the workers are pinned over, 1 if not numa
+		bool					mStop;
+
+	public:
+		explicit CRaid6Pool(int numThread, int numa=0);
+		~CRaid6Pool();
+
+	public:
+		int get_thread_num() const;
+		int is_numa() const;
+		//run fn(arg, 0) ~ fn(arg, numTask-1) on the workers, return when all finished.
+		//taskNode[i] the numa node task i runs on, -1 any, taskNode 0 all any
+		int parallel_for(R6TaskFnType fn, void* arg, int numTask, const int* taskNode=0);
+
+	private:
+		void queue_run(int node, R6TaskFnType fn, void* arg, const int* idx, int count, SBatch* batch);
+		bool pop(int self, STask& task);
+		bool steal(int self, int node, STask& task);
+		void execute(STask& task);
+		void worker_main(int self);
+
+		CRaid6Pool(const CRaid6Pool&);
+		CRaid6Pool& operator=(const CRaid6Pool&);
+	};//end CRaid6Pool
+
+}//end namespace
+
+#endif//_RAID6_POOL_HPP_INCLUDE_
@@ -0,0 +1,168 @@
+/***
+*raid6_rs.cpp - P+Q Reed-Solomon raid6, the code of linux md
+*
+*       Copyright (c) Bingle	All rights reserved.
+*
+*Purpose:
+*       This file implements CRaid6RS: the GF(2^8) tables, the scalar kernel and
+*       the kernel dispatch. the simd kernels are in their instruction set units.
+*
+*Author:
+*		Bingle(BinaryBB@hotmail.com)
+****/
+
+#include <string.h>
+#include <mutex>
+#include <vector>
+#include "raid6_rs.hpp"
+#include "raid6_gf.hpp"
+
+namespace raid6{
+
+SGfTables gGf;
+
+namespace {
+
+//8 bytes per lane in a base_type, the constant multiply byte by byte through the nibble tables
+struct gf_lane_scalar {
+	typedef unsigned long long type;
+	enum { eBytes = 8 };
+
+	static inline type zero()							{ return 0; }
+	static inline type vxor(type a, type b)				{ return a ^ b; }
+	static inline type load(const unsigned char* p)		{ type v; memcpy(&v, p, sizeof(v)); return v; }
+	static inline void store(unsigned char* p, type v)	{ memcpy(p, &v, sizeof(v)); }
+	static inline type mul2(type v) {
+		return ( (v<<1) & 0xfefefefefefefefeULL ) ^ ( ( (v>>7) & 0x0101010101010101ULL ) * 0x1d );
+	}
+	static inline type mulc(type v, const unsigned char* nib) {
+		type r = 0;
+		for(int i=0; i<eBytes; ++i) {
+			unsigned x = (unsigned)( v>>(8*i) ) & 0xff;
+			r |= (type)( nib[x & 15] ^ nib[16 + (x>>4)] ) << (8*i);
+		}
+		return r;
+	}
+};
+
+std::once_flag gRSInitOnce;
+
+//the recover kernel of a variant, the next narrower one if it has none. avx512 runs the avx2 one
+R6GfRecoverFnType get_gf_fn(int kernel) {
+	switch(kernel) {
+	case eKernelAVX512:
+	case eKernelAVX2:	if(gGfRecoverFnAVX2) return gGfRecoverFnAVX2;	//fall through
+	case eKernelSSE2:	if(gGfRecoverFnSSE2) return gGfRecoverFnSSE2;
+	}
+	return CGfRaid6<gf_lane_scalar>::recover;
+}
+
+}//end anonymous namespace
+
+int CRaid6RS::msKernelMask = 0;
+int CRaid6RS::msBestKernel = eKernelScalar;
+
+//the GF tables, and the kernel variants the cpu runs as CRaid6 found them, a variant 
+//without its own kernel runs the next narrower one
+void CRaid6RS::init_once() {
+	unsigned x = 1;
+	for(int i=0; i<255; ++i) {
+		gGf.exp[i] = gGf.exp[i+255] = (unsigned char)x;
+		gGf.log[x] = (unsigned char)i;
+		x <<= 1;
+		if(x & 0x100) x ^= 0x11d;
+	}
+	gGf.exp[510] = gGf.exp[0];
+	gGf.exp[511] = gGf.exp[1];
+	gGf.log[0] = 0;
+	for(int c=0; c<256; ++c) {
+		for(int k=0; k<16; ++k) {
+			gGf.nib[c][k]    = (c && k)? gGf.exp[ gGf.log[c] + gGf.log[k] ] : 0;
+			gGf.nib[c][16+k] = (c && k)? gGf.exp[ gGf.log[c] + gGf.log[k<<4] ] : 0;
+		}
+	}
+
+	CRaid6 r6;
+	msKernelMask = 1<<eKernelScalar;
+	msBestKernel = eKernelScalar;
+	for(int k=eKernelSSE2; k<eKernelNum; ++k) {
+		if( r6.is_kernel_supported(k) ) {
+			msKernelMask |= 1<<k;
+			msBestKernel  = k;
+		}
+	}
+}
+
+CRaid6RS::CRaid6RS() {
+	std::call_once(gRSInitOnce, init_once);
+	mKernel = msBestKernel;
+}
+
+int CRaid6RS::set_kernel(int kernel) {
+	if( !is_kernel_supported(kernel) ) return errKernelNotSupported;
+	mKernel = kernel;
+	return errOK;
+}
+
+int CRaid6RS::get_kernel() const {
+	return mKernel;
+}
+
+int CRaid6RS::is_kernel_supported(int kernel) const {
+	return kernel>=0 && kernel<eKernelNum && ( msKernelMask & (1<<kernel) )!=0;
+}
+
+int CRaid6RS::get_max_disk_num() const {
+	return eRSMaxDiskNum;
+}
+
+//*****************************************************************************
+//Function:
+//		recover missing block of a P+Q stripe, other block's data not changed.
+//Param:
+//		block:		buffers on all disks, any alignment. block[eDiaIdx] is Q,
+//					block[eRowIdx] is P, the data disks 2~ numDisk-1.
+//		numBytes:	length of each buffer, any length.
+//		numDisk:	total disk number, 3~eRSMaxDiskNum.
+//		missingDisk1, missingDisk2:	as CRaid6::recover().
+//Return:
+//		return errOK if success, otherwise, return error code
+//Comment:
+//		multiples of eRSLaneBytes run in place, the tail through zero padded
+//		scratch, every byte of the code is independent.
+//*****************************************************************************
+int CRaid6RS::recover(T** block, size_t numBytes, int numDisk, int missingDisk1, int missingDisk2) {
+	if(numDisk<3 || numDisk>eRSMaxDiskNum )		return errInvalidDiskNum;
+	if(missingDisk1<0 || missingDisk1>=numDisk) return errInvalidMissIdx;
+	if(missingDisk2<0 || missingDisk2>=numDisk) return errInvalidMissIdx;
+	if( numBytes==0 )	return errSizeNotAligned;
+	if( !block ) return errNullBlockPointer;
+	unsigned char* b[eLimitDiskNum+1];
+	for(int i=0; i<numDisk; ++i) {
+		if( 0==block[i]) return errNullBlockPointer;
+		b[i] = (unsigned char*)block[i];
+	}
+	if(missingDisk1 > missingDisk2) {
+		int tmp = missingDisk1;
+		missingDisk1 = missingDisk2;
+		missingDisk2 = tmp;
+	}
+	R6GfRecoverFnType fn = get_gf_fn(mKernel);
+	size_t bulkBytes = numBytes/eRSLaneBytes*eRSLaneBytes;
+	int result = bulkBytes? fn(b, bulkBytes, numDisk, missingDisk1, missingDisk2) : errOK;
+	if(errOK==result && bulkBytes<numBytes) {
+		size_t n = numBytes-bulkBytes;
+		std::vector<unsigned char> scratch( (size_t)eRSLaneBytes*numDisk );
+		unsigned char* t[eLimitDiskNum+1];
+		for(int i=numDisk-1; i>=0; --i) {
+			t[i] = &scratch[i*eRSLaneBytes];
+			if(i!=missingDisk1 && i!=missingDisk2) memcpy(t[i], b[i]+bulkBytes, n);
+		}
+		result = fn(t, eRSLaneBytes, numDisk, missingDisk1, missingDisk2);
+		memcpy(b[missingDisk1]+bulkBytes, t[missingDisk1], n);
+		memcpy(b[missingDisk2]+bulkBytes, t[missingDisk2], n);
+	}
+	return result;
+}
+
+}//end namespace raid6
@@ -0,0 +1,67 @@
+/***
+*raid6_rs.hpp - P+Q Reed-Solomon raid6, the code of linux md
+*
+*       Copyright (c) Bingle	All rights reserved.
+*
+*Purpose:
+*       This file contains the engine of the P+Q code over GF(2^8), with the same
+*       recover contract as CRaid6, for arrays built by linux md raid6.
+*
+*Author:
+*		Bingle(BinaryBB@hotmail.com)
+****/
+
+#ifndef _RAID6_RS_HPP_INCLUDE_
+#define _RAID6_RS_HPP_INCLUDE_
+
+#include "raid6.hpp"
+
+namespace raid6{
+
+	enum EnumRSConsts
+	{
+		eRSMaxDiskNum = 257,					//255 data disks, GF(2^8) has 255 powers of g
+		eRSLaneBytes  = 64,						//the kernels run multiples of it, the tail through scratch
+	};
+
+//*****************************************************************************
+//class CRaid6RS
+//Purpose:
+//  recover() of a P+Q stripe. block[eRowIdx] is P, the xor of the data, and
+//  block[eDiaIdx] is Q, sum of g^z * data z over GF(2^8), polynomial 0x11d,
+//  g = 2, z = disk-2, as md's raid6 with data disk z the z-th data chunk of
+//  the stripe. md rotates P, Q and the data over the members stripe by stripe,
+//  map the members' chunks of a stripe to the block entries before each call.
+//Comment:
+//  the syndromes run on simd lanes, the constant multiplies of the data
+//  solves on byte shuffles (avx2) or nibble tables (scalar). the avx512 unit
+//  is built for avx512f only, which has no byte shuffle, avx2 serves there.
+//*****************************************************************************
+	class CRaid6RS{
+	private:
+		static int msKernelMask;				//bit k set if kernel variant k is usable on this cpu
+		static int msBestKernel;
+
+		int mKernel;							//kernel variant used by this engine
+
+	public:
+		CRaid6RS();
+
+	public:
+		int recover(T** block, size_t numBytes, int numDisk, int missingDisk1, int missingDisk2);
+
+		int set_kernel(int kernel);				//EnumLibKernel, errKernelNotSupported if not usable
+		int get_kernel() const;
+		int is_kernel_supported(int kernel) const;
+		int get_max_disk_num() const;			//eRSMaxDiskNum
+
+	private:
+		static void init_once();
+
+		CRaid6RS(const CRaid6RS&);
+		CRaid6RS& operator=(const CRaid6RS&);
+
+	};//end CRaid6RS
+
+}//end namespace
+#endif//_RAID6_RS_HPP_INCLUDE_
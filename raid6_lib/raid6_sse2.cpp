@@ -0,0 +1,99 @@
+/***
+*raid6_sse2.cpp - sse2 kernels for raid6 library
+*
+*       Copyright (c) Bingle	All rights reserved.
+*
+*Purpose:
+*       This file instantiates CVectorRaid6 and the P+Q CGfRaid6 on 128bit lanes.
+*       CRaid6 only picks these kernels if the cpu supports sse2.
+*
+*Author:
+*		Bingle(BinaryBB@hotmail.com)
+****/
+
+#include "raid6_engine.hpp"
+#include "raid6_gf.hpp"
+
+#ifdef LIB_SIMD_SSE2_ENABLED
+#include <emmintrin.h>
+
+namespace raid6{
+namespace {
+
+//2 rows of a group per lane
+template<int _P>
+struct lane_sse2 {
+	typedef __m128i type;
+	enum { eWidth = 2, ePrime = _P };
+	template<int _ND> class engine { public: typedef CVectorRaid6<_ND, lane_sse2> type; };
+
+	static inline type zero()						{ return _mm_setzero_si128(); }
+	static inline type set1(T t)					{ return _mm_set1_epi64x(t); }
+	static inline type vxor(type a, type b)			{ return _mm_xor_si128(a, b); }
+	static inline type load(const T* p)				{ return _mm_loadu_si128( (const __m128i*)p ); }
+	static inline void store(T* p, type v)			{ _mm_storeu_si128( (__m128i*)p, v ); }
+	static inline void stream(T* p, type v)			{ _mm_stream_si128( (__m128i*)p, v ); }
+	static inline void fence()						{ _mm_sfence(); }
+	static inline void prefetch(const T* p)			{ _mm_prefetch( (const char*)p, _MM_HINT_T0 ); }
+
+	//element _I of a group, wrapped around P, row P-1 is 0
+	template<int _I> 
+	static inline T at(const T* p)					{ return _I>=0 ? p[_I] : ( _I==-1 ? 0 : p[_I+ePrime] ); }
+	template<int _K, int _V>
+	static inline type rot(const T* p) {
+		enum { eLo = _V*eWidth - _K };
+		if( eLo>=0 ) return load( p + eLo );
+		return _mm_set_epi64x( at<eLo+1>(p), at<eLo>(p) );
+	}
+};
+
+//16 bytes of a P+Q stripe per lane, no byte shuffle in sse2: the constant multiply
+//adds up the doublings of v for the bits of c
+struct gf_lane_sse2 {
+	typedef __m128i type;
+	enum { eBytes = 16 };
+
+	static inline type zero()							{ return _mm_setzero_si128(); }
+	static inline type vxor(type a, type b)				{ return _mm_xor_si128(a, b); }
+	static inline type load(const unsigned char* p)		{ return _mm_loadu_si128( (const __m128i*)p ); }
+	static inline void store(unsigned char* p, type v)	{ _mm_storeu_si128( (__m128i*)p, v ); }
+	static inline type mul2(type v) {
+		return _mm_xor_si128( _mm_add_epi8(v, v), 
+			_mm_and_si128( _mm_cmpgt_epi8(_mm_setzero_si128(), v), _mm_set1_epi8(0x1d) ) );
+	}
+	static inline type mulc(type v, const unsigned char* nib) {
+		unsigned c = nib[1];
+		type r = _mm_setzero_si128();
+		for(; c; c>>=1, v = mul2(v)) {
+			if(c & 1) r = _mm_xor_si128(r, v);
+		}
+		return r;
+	}
+};
+
+}//end anonymous namespace
+
+//constant initialized, the table of a prime the lanes could not serve is all 0
+const SRaid6RecoverTable gRecoverFnSetSSE2[ePrimeNum] = {
+	CRecoverTable< lane_sse2<5> >::table(),
+	CRecoverTable< lane_sse2<17> >::table(),
+	CRecoverTable< lane_sse2<257> >::table(),
+};
+const R6LoopRecoverFnType gLoopRecoverFnSetSSE2[ePrimeNum] = {
+	CLoopVectorTable< lane_sse2<5> >::fn(),
+	CLoopVectorTable< lane_sse2<17> >::fn(),
+	CLoopVectorTable< lane_sse2<257> >::fn(),
+};
+const R6GfRecoverFnType gGfRecoverFnSSE2 = CGfRaid6<gf_lane_sse2>::recover;
+
+}//end namespace raid6
+
+#else //LIB_SIMD_SSE2_ENABLED
+
+namespace raid6{
+const SRaid6RecoverTable gRecoverFnSetSSE2[ePrimeNum] = {};
+const R6LoopRecoverFnType gLoopRecoverFnSetSSE2[ePrimeNum] = {};
+const R6GfRecoverFnType gGfRecoverFnSSE2 = 0;
+}//end namespace raid6
+
+#endif//LIB_SIMD_SSE2_ENABLED
@@ -0,0 +1,66 @@
+/***
+*raid6_sse42.cpp - crc32c kernels for raid6 library
+*
+*       Copyright (c) Bingle	All rights reserved.
+*
+*Purpose:
+*       This file instantiates the fused parity and crc32c kernels on the sse4.2 
+*       crc32 instruction. CRaid6 only picks them if the cpu supports sse4.2.
+*
+*Author:
+*		Bingle(BinaryBB@hotmail.com)
+****/
+
+#include "raid6_engine.hpp"
+
+#ifdef LIB_SIMD_SSE42_ENABLED
+#include <nmmintrin.h>
+
+namespace raid6{
+namespace {
+
+//crc32c of one base_type
+struct crc_sse42 {
+	static inline unsigned update(unsigned crc, T v) {
+	#if defined(__x86_64__) || defined(_M_X64)
+		return (unsigned)_mm_crc32_u64( crc, (unsigned long long)v );
+	#else
+		crc = _mm_crc32_u32( crc, (unsigned)v );
+		return _mm_crc32_u32( crc, (unsigned)( (unsigned long long)v>>32 ) );
+	#endif
+	}
+};
+
+//disks side by side, so numDisk crc chains are in flight
+void crc_blocks_sse42(T** block, size_t numUnits, int numDisk, unsigned* crc) {
+	for(size_t u=0; u<numUnits; ++u) {
+		for(int j=0; j<numDisk; ++j) {
+			crc[j] = crc_sse42::update( crc[j], block[j][u] );
+		}
+	}
+}
+
+}//end anonymous namespace
+
+const SRaid6CrcTable gEncodeCrcFnSetSSE42[ePrimeNum] = {
+	CEncodeCrcTable<5, crc_sse42>::table(),
+	CEncodeCrcTable<17, crc_sse42>::table(),
+	CEncodeCrcTable<257, crc_sse42>::table(),
+};
+
+R6CrcBlocksFnType get_crc_blocks_sse42() {
+	return crc_blocks_sse42;
+}
+
+}//end namespace raid6
+
+#else //LIB_SIMD_SSE42_ENABLED
+
+namespace raid6{
+const SRaid6CrcTable gEncodeCrcFnSetSSE42[ePrimeNum] = {};
+R6CrcBlocksFnType get_crc_blocks_sse42() {
+	return 0;
+}
+}//end namespace raid6
+
+#endif//LIB_SIMD_SSE42_ENABLED
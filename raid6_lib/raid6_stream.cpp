@@ -0,0 +1,130 @@
+/***
+*raid6_stream.cpp - streaming recover for raid6 library
+*
+*       Copyright (c) Bingle	All rights reserved.
+*
+*Purpose:
+*       This file contains the implementation of the streaming encoder/decoder.
+*
+*Author:
+*		Bingle(BinaryBB@hotmail.com)
+****/
+
+#include <string.h>
+#include "raid6_stream.hpp"
+
+namespace raid6{
+
+CRaid6Stream::CRaid6Stream(CRaid6& engine, size_t windowBytes)
+	: mR6(engine), mWindowBytes(windowBytes), mWindow(0), mGroup(0), mFill(0), mTotal(0), 
+	mNumDisk(0), mMiss1(0), mMiss2(0), mOut(0), mOutArg(0)
+{
+}
+
+CRaid6Stream::~CRaid6Stream() {
+}
+
+int CRaid6Stream::begin(int numDisk, int missingDisk1, int missingDisk2, R6StreamOutFnType out, void* arg) {
+	if(numDisk<3 || numDisk>mR6.get_max_disk_num() )	return errInvalidDiskNum;
+	if(missingDisk1<0 || missingDisk1>=numDisk) return errInvalidMissIdx;
+	if(missingDisk2<0 || missingDisk2>=numDisk) return errInvalidMissIdx;
+	if(!out) return errFAIL;
+
+	mGroup  = mR6.get_align_bytes();
+	mWindow = mWindowBytes<mGroup? mGroup : mWindowBytes/mGroup*mGroup;
+	mStage.resize( mWindow/sizeof(T)*numDisk );
+	for(int i=0; i<numDisk; ++i) {
+		mBuf[i] = &mStage[0] + mWindow/sizeof(T)*i;
+	}
+	mFill    = 0;
+	mTotal   = 0;
+	mNumDisk = numDisk;
+	mMiss1   = missingDisk1;
+	mMiss2   = missingDisk2;
+	mOut     = out;
+	mOutArg  = arg;
+	return errOK;
+}
+
+int CRaid6Stream::push(const void* const* piece, size_t numBytes) {
+	if(!mOut) return errFAIL;
+	if(!piece) return errNullBlockPointer;
+	for(int i=0; i<mNumDisk; ++i) {
+		if(i!=mMiss1 && i!=mMiss2 && !piece[i]) return errNullBlockPointer;
+	}
+
+	enum {ePtrMask = sizeof(T)-1 };
+	T* b[eLimitDiskNum+1];
+	size_t off = 0;
+	int result = errOK;
+	while(errOK==result && off<numBytes) {
+		size_t left = numBytes - off;
+		//after a partial stage off is where the window filled up, any byte offset
+		int direct = 0==mFill && left>=mGroup;
+		for(int i=0; direct && i<mNumDisk; ++i) {
+			if(i!=mMiss1 && i!=mMiss2 && ( ((size_t)piece[i] + off) & ePtrMask )!=0 ) direct = 0;
+		}
+		if(direct) {
+			//whole groups straight from the caller's buffers, only the missing go to the windows
+			size_t n = left/mGroup*mGroup;
+			if(n>mWindow) n = mWindow;
+			for(int i=0; i<mNumDisk; ++i) {
+				b[i] = (i==mMiss1 || i==mMiss2)? mBuf[i] : (T*)( (char*)piece[i] + off );
+			}
+			result = run(b, n);
+			off += n;
+			continue;
+		}
+		//stage the rest, a partial group is carried to the next push
+		size_t n = mWindow - mFill;
+		if(n>left) n = left;
+		for(int i=0; i<mNumDisk; ++i) {
+			if(i!=mMiss1 && i!=mMiss2) {
+				memcpy( (char*)mBuf[i] + mFill, (const char*)piece[i] + off, n );
+			}
+		}
+		mFill += n;
+		off   += n;
+		if(mFill==mWindow) {
+			mFill = 0;
+			result = run(mBuf, mWindow);
+		}
+	}
+	mTotal += off;
+	return result;
+}
+
+int CRaid6Stream::finish(const void* diaTail) {
+	if(!mOut) return errFAIL;
+	int result = errOK;
+	//a partial group is only ever left staged, its diagonal parity fits in the window
+	size_t tail = mR6.get_dia_bytes(mFill) - mFill;
+	if(tail && eDiaIdx!=mMiss1 && eDiaIdx!=mMiss2) {
+		if(diaTail) memcpy( (char*)mBuf[eDiaIdx] + mFill, diaTail, tail );
+		else result = errNullBlockPointer;
+	}
+	if(errOK==result && mFill>0) {
+		result = run(mBuf, mFill);
+	}
+	mFill = 0;
+	mOut  = 0;
+	return result;
+}
+
+unsigned long long CRaid6Stream::get_total_bytes() const {
+	return mTotal;
+}
+
+//one window recovered, a missing diagonal parity hands out its last group whole
+int CRaid6Stream::run(T** block, size_t numBytes) {
+	int result = mR6.recover(block, numBytes, mNumDisk, mMiss1, mMiss2);
+	if(errOK==result) {
+		result = mOut(mOutArg, mMiss1, block[mMiss1], eDiaIdx==mMiss1? mR6.get_dia_bytes(numBytes) : numBytes);
+	}
+	if(errOK==result && mMiss2!=mMiss1) {
+		result = mOut(mOutArg, mMiss2, block[mMiss2], eDiaIdx==mMiss2? mR6.get_dia_bytes(numBytes) : numBytes);
+	}
+	return result;
+}
+
+}//end namespace raid6
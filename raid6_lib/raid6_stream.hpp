@@ -0,0 +1,74 @@
+/***
+*raid6_stream.hpp - streaming recover for raid6 library
+*
+*       Copyright (c) Bingle	All rights reserved.
+*
+*Purpose:
+*       This file contains the streaming encoder/decoder, it takes the disks' data
+*       in pieces of any size and hands out parity or recovered data as groups
+*       complete, so a whole member never needs to be in memory.
+*
+*Author:
+*		Bingle(BinaryBB@hotmail.com)
+****/
+
+#ifndef _RAID6_STREAM_HPP_INCLUDE_
+#define _RAID6_STREAM_HPP_INCLUDE_
+
+#include <vector>
+#include "raid6.hpp"
+
+namespace raid6{
+
+	//receives numBytes of recovered data for disk diskIdx, following the bytes given before.
+	//return errOK to go on, other value stops the stream and is returned by push()/finish().
+	typedef int ( *R6StreamOutFnType )(void* arg, int diskIdx, const void* data, size_t numBytes);
+
+	//*****************************************************************************
+	// class CRaid6Stream
+	// run recover over a stream. every push() gives the next numBytes of all
+	// surviving disks, the missing disks' data come out through the out function.
+	// with missing (eDiaIdx, eRowIdx) it is the encoder, otherwise the decoder.
+	// memory used is windowBytes per disk.
+	//*****************************************************************************
+	class CRaid6Stream{
+	private:
+		CRaid6&				mR6;
+		size_t				mWindowBytes;			//window size asked, rounded by begin()
+		size_t				mWindow;				//bytes of each disk per recover call
+		size_t				mGroup;					//align bytes of the engine's prime
+		std::vector<T>		mStage;					//window of each disk
+		T*					mBuf[eLimitDiskNum+1];	//window start of each disk in mStage
+		size_t				mFill;					//bytes staged in each window
+		unsigned long long	mTotal;					//bytes pushed of each disk
+		int					mNumDisk;
+		int					mMiss1;
+		int					mMiss2;
+		R6StreamOutFnType	mOut;
+		void*				mOutArg;
+
+	public:
+		explicit CRaid6Stream(CRaid6& engine, size_t windowBytes = raid6_config_tag::eStreamBytes);
+		~CRaid6Stream();
+
+	public:
+		//start a stream, the engine's kernel and threads are used
+		int begin(int numDisk, int missingDisk1, int missingDisk2, R6StreamOutFnType out, void* arg);
+		//piece[i] points to the next numBytes of disk i, missing disks' entries not used
+		int push(const void* const* piece, size_t numBytes);
+		//flush what is staged, total bytes per disk of any length. if the last group is partial and
+		//the diagonal parity is not missing, diaTail points to its bytes after the total, 
+		//get_dia_bytes(total)-total of them. a missing one comes out get_dia_bytes(total) long
+		int finish(const void* diaTail = 0);
+		unsigned long long get_total_bytes() const;
+
+	private:
+		int run(T** block, size_t numBytes);
+
+		CRaid6Stream(const CRaid6Stream&);
+		CRaid6Stream& operator=(const CRaid6Stream&);
+	};//end CRaid6Stream
+
+}//end namespace
+
+#endif//_RAID6_STREAM_HPP_INCLUDE_
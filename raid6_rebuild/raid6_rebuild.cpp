@@ -0,0 +1,330 @@
+/***
+*raid6_rebuild.cpp - rebuild missing members of a raid6 array
+*
+*       Copyright (c) Bingle	All rights reserved.
+*
+*Purpose:
+*       Stream all members of an array from image files or block devices, recover
+*       the missing ones batch by batch and write them out.
+*       usage: raid6_rebuild -m miss1[,miss2] [-p prime] [-b KBPerBatch] [-q depth]
+*                            [-t threads] member0 member1 ... memberN-1
+*       the missing members' paths are the outputs, created if not exist.
+*
+*       Each member has its own I/O thread, reading (or writing) it sequentially
+*       with O_DIRECT into a ring of aligned batches, while the main thread runs
+*       recover on the batch that is complete. So the rebuild runs at the speed
+*       of the slowest disk as long as recover is faster.
+*
+*Author:
+*		Bingle(BinaryBB@hotmail.com)
+****/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+#include "../raid6_lib/raid6.hpp"
+
+using namespace raid6;
+
+enum {
+	eIoAlign		= 4096,				//O_DIRECT buffer, offset and length unit
+	eDefBatchKB		= 1024,				//bytes of each member per batch
+	eDefDepth		= 4,				//batches in the ring
+	eMaxDepth		= 64,
+};
+
+//state of a batch slot, it goes round free -> read -> computed -> free
+enum EnumSlotState {
+	eSlotFree		= 0,				//survivors being read into it
+	eSlotRead		= 1,				//all survivors read, waiting recover
+	eSlotComputed	= 2,				//missing members recovered, being written
+};
+
+struct SSlot {
+	std::vector<T*>		block;			//buffer of each member
+	long long			batch;			//batch index the slot serves now
+	int					state;
+	int					pending;		//reads or writes not finished of the state
+};
+
+struct SMember {
+	const char*			path;
+	int					fd;
+	int					direct;			//opened with O_DIRECT
+	int					missing;
+};
+
+class CRebuilder {
+private:
+	CRaid6					mR6;
+	std::vector<SMember>	mMember;
+	std::vector<SSlot>		mSlot;
+	unsigned long long		mSize;		//bytes of each member
+	size_t					mBatch;		//bytes of each member per batch
+	long long				mNumBatch;
+	int						mMiss1;
+	int						mMiss2;
+	int						mNumMiss;
+	int						mError;		//first error met, stops all stages
+	std::mutex				mLock;
+	std::condition_variable	mChanged;
+
+public:
+	CRebuilder() : mSize(0), mBatch(0), mNumBatch(0), mMiss1(0), mMiss2(0), mNumMiss(0), mError(errOK) {}
+	~CRebuilder() {
+		for(size_t i=0; i<mMember.size(); ++i) {
+			if(mMember[i].fd>=0) close(mMember[i].fd);
+		}
+		for(size_t s=0; s<mSlot.size(); ++s) {
+			for(size_t i=0; i<mSlot[s].block.size(); ++i) {
+				free(mSlot[s].block[i]);
+			}
+		}
+	}
+
+	int open_members(char** paths, int numDisk, int miss1, int miss2, int prime, int numThread) {
+		if( errOK!=mR6.set_prime(prime) ) {
+			printf("prime %d not supported\n", prime);
+			return errInvalidPrime;
+		}
+		if(numDisk<3 || numDisk>mR6.get_max_disk_num()) {
+			printf("%d members, should be 3~%d for prime %d\n", numDisk, mR6.get_max_disk_num(), prime);
+			return errInvalidDiskNum;
+		}
+		if(miss1<0 || miss1>=numDisk || miss2<0 || miss2>=numDisk) {
+			printf("missing member should be 0~%d\n", numDisk-1);
+			return errInvalidMissIdx;
+		}
+		mR6.set_thread_num(numThread);
+		mMiss1   = miss1;
+		mMiss2   = miss2;
+		mNumMiss = miss1==miss2? 1 : 2;
+		SMember none = { 0, -1, 0, 0 };
+		mMember.assign(numDisk, none);
+		for(int i=0; i<numDisk; ++i) {
+			SMember& m = mMember[i];
+			m.path    = paths[i];
+			m.missing = i==miss1 || i==miss2;
+			int flags = m.missing? O_WRONLY|O_CREAT : O_RDONLY;
+			m.direct  = 1;
+			m.fd      = open(m.path, flags|O_DIRECT, 0644);
+			if(m.fd<0 && EINVAL==errno) {
+				//tmpfs and some others do not take O_DIRECT
+				m.direct = 0;
+				m.fd     = open(m.path, flags, 0644);
+			}
+			if(m.fd<0) {
+				printf("open %s: %s\n", m.path, strerror(errno));
+				return errFAIL;
+			}
+			if(m.missing) continue;
+			unsigned long long size = member_size(m.fd);
+			if(mSize && size!=mSize) {
+				printf("%s: size %llu, other members %llu\n", m.path, size, mSize);
+				return errSizeNotAligned;
+			}
+			mSize = size;
+		}
+		if(0==mSize || mSize%mR6.get_align_bytes()!=0) {
+			printf("member size %llu, should be a multiple of %d\n", mSize, (int)mR6.get_align_bytes());
+			return errSizeNotAligned;
+		}
+		//an old image file at a missing member's path keeps no bytes past the array
+		for(int i=0; i<numDisk; ++i) {
+			SMember& m = mMember[i];
+			struct stat st;
+			if( !m.missing || fstat(m.fd, &st) || !S_ISREG(st.st_mode) ) continue;
+			if( ftruncate(m.fd, (off_t)mSize) ) {
+				printf("truncate %s: %s\n", m.path, strerror(errno));
+				return errFAIL;
+			}
+		}
+		return errOK;
+	}
+
+	int alloc_ring(size_t batchBytes, int depth) {
+		//a batch is whole O_DIRECT units and whole groups
+		size_t unit = eIoAlign;
+		while(unit%mR6.get_align_bytes()!=0) unit += eIoAlign;
+		mBatch = batchBytes<unit? unit : batchBytes/unit*unit;
+		mNumBatch = (long long)( (mSize + mBatch-1)/mBatch );
+		if(depth>mNumBatch) depth = (int)mNumBatch;
+		mSlot.resize(depth);
+		for(int s=0; s<depth; ++s) {
+			SSlot& slot = mSlot[s];
+			slot.block.assign(mMember.size(), (T*)0);
+			for(size_t i=0; i<mMember.size(); ++i) {
+				if( posix_memalign( (void**)&slot.block[i], eIoAlign, mBatch ) ) {
+					slot.block[i] = 0;
+					printf("out of memory\n");
+					return errFAIL;
+				}
+			}
+			slot.batch   = s;
+			slot.state   = eSlotFree;
+			slot.pending = (int)mMember.size() - mNumMiss;
+		}
+		return errOK;
+	}
+
+	int run() {
+		typedef std::chrono::steady_clock steady_t;
+		steady_t::time_point t0 = steady_t::now();
+		std::vector<std::thread> io;
+		for(size_t i=0; i<mMember.size(); ++i) {
+			io.push_back( std::thread(&CRebuilder::io_main, this, (int)i) );
+		}
+		for(long long b=0; b<mNumBatch; ++b) {
+			SSlot& slot = mSlot[b%mSlot.size()];
+			if( !wait_slot(slot, b, eSlotRead) ) break;
+			int result = mR6.recover( &slot.block[0], batch_bytes(b), (int)mMember.size(), mMiss1, mMiss2 );
+			std::lock_guard<std::mutex> lk(mLock);
+			if(errOK!=result) {
+				if(errOK==mError) mError = result;
+			}
+			slot.state   = eSlotComputed;
+			slot.pending = mNumMiss;
+			mChanged.notify_all();
+		}
+		for(size_t i=0; i<io.size(); ++i) {
+			io[i].join();
+		}
+		for(size_t i=0; i<mMember.size() && errOK==mError; ++i) {
+			if( mMember[i].missing && fsync(mMember[i].fd) && EINVAL!=errno ) {
+				printf("sync %s: %s\n", mMember[i].path, strerror(errno));
+				mError = errFAIL;
+			}
+		}
+		double sec = std::chrono::duration<double>(steady_t::now() - t0).count();
+		if(errOK==mError) {
+			printf("rebuilt %llu bytes of each member in %.2fs, %.1f MB/s per member\n",
+				mSize, sec, sec>0? mSize/sec/1e6 : 0.0);
+		}
+		return mError;
+	}
+
+private:
+	static unsigned long long member_size(int fd) {
+		struct stat st;
+		if( fstat(fd, &st) ) return 0;
+		if( S_ISBLK(st.st_mode) ) {
+			unsigned long long size = 0;
+			return ioctl(fd, BLKGETSIZE64, &size)? 0 : size;
+		}
+		return (unsigned long long)st.st_size;
+	}
+
+	size_t batch_bytes(long long b) const {
+		unsigned long long off = (unsigned long long)b*mBatch;
+		return mSize-off<mBatch? (size_t)(mSize-off) : mBatch;
+	}
+
+	//wait until slot serves batch b in the state, false if stopping on error
+	bool wait_slot(SSlot& slot, long long b, int state) {
+		std::unique_lock<std::mutex> lk(mLock);
+		while( errOK==mError && !(slot.batch==b && slot.state==state) ) {
+			mChanged.wait(lk);
+		}
+		return errOK==mError;
+	}
+
+	//survivors read each batch into the ring, missing members write the recovered ones out
+	void io_main(int idx) {
+		SMember& m = mMember[idx];
+		for(long long b=0; b<mNumBatch; ++b) {
+			SSlot& slot = mSlot[b%mSlot.size()];
+			if( !wait_slot(slot, b, m.missing? eSlotComputed : eSlotFree) ) return;
+			int result = transfer(m, slot.block[idx], batch_bytes(b), (unsigned long long)b*mBatch);
+			std::lock_guard<std::mutex> lk(mLock);
+			if(errOK!=result) {
+				if(errOK==mError) mError = result;
+				mChanged.notify_all();
+				return;
+			}
+			if(--slot.pending==0) {
+				if(m.missing) {
+					slot.batch  += mSlot.size();
+					slot.state   = eSlotFree;
+					slot.pending = (int)mMember.size() - mNumMiss;
+				}
+				else {
+					slot.state   = eSlotRead;
+				}
+				mChanged.notify_all();
+			}
+		}
+	}
+
+	int transfer(SMember& m, T* buf, size_t numBytes, unsigned long long off) {
+		if( m.direct && numBytes%eIoAlign!=0 ) {
+			//the tail is not whole O_DIRECT units, go through the page cache for it
+			m.direct = 0;
+			fcntl( m.fd, F_SETFL, fcntl(m.fd, F_GETFL) & ~O_DIRECT );
+		}
+		char* p = (char*)buf;
+		while(numBytes>0) {
+			ssize_t n = m.missing? pwrite(m.fd, p, numBytes, (off_t)off) : pread(m.fd, p, numBytes, (off_t)off);
+			if(n<0 && EINTR==errno) continue;
+			if(n<=0) {
+				printf("%s %s at %llu: %s\n", m.missing? "write" : "read", m.path, off, n<0? strerror(errno) : "end of file");
+				return errFAIL;
+			}
+			p        += n;
+			off      += n;
+			numBytes -= n;
+		}
+		return errOK;
+	}
+};
+
+static int usage() {
+	printf("usage: raid6_rebuild -m miss1[,miss2] [-p prime] [-b KBPerBatch] [-q depth] [-t threads] member0 member1 ... memberN-1\n"
+		"  -m  index of the missing members, their paths are written\n"
+		"  -p  prime of the array, 5 17 or 257, default %d\n"
+		"  -b  KB of each member per batch, default %d\n"
+		"  -q  batches in flight, default %d\n"
+		"  -t  recover worker threads, default 1\n", (int)P, (int)eDefBatchKB, (int)eDefDepth);
+	return errFAIL;
+}
+
+int main(int argc, char* argv[]) {
+	int miss1 = -1, miss2 = -1;
+	int prime = P, batchKB = eDefBatchKB, depth = eDefDepth, threads = 1;
+	int i = 1;
+	for(; i<argc && '-'==argv[i][0]; i+=2) {
+		if(i+1>=argc) return usage();
+		const char* v = argv[i+1];
+		switch(argv[i][1]) {
+		case 'm':
+			if( sscanf(v, "%d,%d", &miss1, &miss2)<2 ) miss2 = miss1;
+			break;
+		case 'p': prime   = atoi(v); break;
+		case 'b': batchKB = atoi(v); break;
+		case 'q': depth   = atoi(v); break;
+		case 't': threads = atoi(v); break;
+		default:  return usage();
+		}
+	}
+	if(miss1<0 || batchKB<=0 || depth<1 || depth>eMaxDepth) return usage();
+
+	CRebuilder rebuilder;
+	int result = rebuilder.open_members(argv+i, argc-i, miss1, miss2, prime, threads);
+	if(errOK==result) result = rebuilder.alloc_ring( (size_t)batchKB*1024, depth );
+	if(errOK==result) result = rebuilder.run();
+	return result;
+}
@@ -17,8 +17,18 @@
 #include <string.h>
 #include <time.h>
 #include <assert.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
 
 #include "../raid6_lib/raid6.hpp"
+#include "../raid6_lib/raid6_async.hpp"
+#include "../raid6_lib/raid6_stream.hpp"
+#include "../raid6_lib/raid6_rs.hpp"
+#include "../raid6_lib/raid6_layout.hpp"
+#include "../raid6_lib/raid6_cache.hpp"
+#include "../raid6_lib/raid6_numa.hpp"
 
 using namespace raid6;
 
@@ -233,9 +243,10 @@ protected:
 	int         mNumBuf;
 
 	CRaid6		mR6;
+	CRaid6RS	mRS;							//the eUseEx provider, P+Q code of linux md
 
-	double mTime[2][20][8];
-	int	mCount[2][20][8];
+	double mTime[2][eLimitDiskNum+1][8];
+	int	mCount[2][eLimitDiskNum+1][8];
 	CCycleTimer timer[2];
 
 public:
@@ -257,18 +268,36 @@ public:
 
 		bound(mIter, 1, 1024);
 		bound(blockSize, 256, 1024*1024*1024);
-		bound(mNumDisk, 3, (int)raid6::eImpDiskNum);
+		bound(mNumDisk, 3, mR6.get_max_disk_num());
+		int align = (int)mR6.get_align_bytes();
+		mBlockSize = (mBlockSize + align-1)/align*align;
 		bound(missDisk1, 0, mNumDisk-1);
 		bound(missDisk2, 0, mNumDisk-1);
 		bound(mCompareMode, -2, 1);
+		if(mCompareMode!=eCompareMyOnly) {
+			bound(mNumDisk, 3, mRS.get_max_disk_num());
+		}
 
 		return 0;
 	}
 	void dump(){
-		printf("raid6 tester: diskNum=%d, iterate=%d, useMde=%d, blockSize=%d\n",
-			mNumDisk, mIter, mCompareMode, mBlockSize);
+		printf("raid6 tester: diskNum=%d, iterate=%d, useMde=%d, blockSize=%d, kernel=%d, family=%d, threads=%d, prime=%d\n",
+			mNumDisk, mIter, mCompareMode, mBlockSize, mR6.get_kernel(), mR6.get_family(), mR6.get_thread_num(), mR6.get_prime());
 		return;
 	}
+	int setKernel(int kernel) {
+		mRS.set_kernel(kernel);
+		return mR6.set_kernel(kernel);
+	}
+	int setFamily(int family) {
+		return mR6.set_family(family);
+	}
+	int setThreadNum(int numThread) {
+		return mR6.set_thread_num(numThread);
+	}
+	int setPrime(int prime) {
+		return mR6.set_prime(prime);
+	}
 
 	template<class T, int align> 
 	T** prepareBuf(int bufBytes, int numBuf, int init){
@@ -315,11 +344,9 @@ public:
 			}
 	}
 	int runTest() {
-		enum{
-			eN = eMaxDiskNum+4,
-		};
+		int numBuf = mNumDisk+4;
 		//init buffer
-		T** p = prepareBuf<T, 16>(mBlockSize, eN, 1);
+		T** p = prepareBuf<T, 64>(mBlockSize, numBuf, 1);
 
 		int errorFlag = 0;
 		int provider;
@@ -329,7 +356,10 @@ public:
 		memset( (void*)mCount, 0, sizeof(mCount) );
 
 		//test all	
+		int prefetch = mR6.get_prefetch();
 		for(int iter=0; iter<mIter; ++iter) {
+			//every prefetch mode in turn, ePrefetchOn first streams whatever the block size
+			mR6.set_prefetch( ePrefetchNum-1 - iter%ePrefetchNum );
 			if (mCompareMode >= 0 ) {
 				provider = mCompareMode & 0x01;
 			}
@@ -338,32 +368,116 @@ public:
 			}            
 
 			for( int nDisk= mNumDisk; nDisk>=3; --nDisk ) {
+				if(mCompareMode==-2) { //mix the providers, each one recovers on the parities it built
+					provider = rand() & 0x01;
+				}
 				randBuffer( p[rand()%nDisk ], mBlockSize, 0, eRandAll);
 
 				//build diagonal/row parity
 				recover_wrapper( (T**)p, mBlockSize, nDisk, 0, 0,  provider); 
 				recover_wrapper( (T**)p, mBlockSize, nDisk, 1, 1,  provider); 
 
+				//the P+Q code of the other provider against a plain byte by byte reference
+				if( checkRS( (T**)p, numBuf, nDisk ) ) {
+					errorFlag = 1;
+				}
+
+				//the checks below run CRaid6 on the parities built above
+				if(provider==eUseMy) {
+					//small write on one data disk, update parities and compare to rebuilt ones
+					if(nDisk>3 && checkUpdate( (T**)p, numBuf, nDisk, iter & 0x01 ) ) {
+						errorFlag = 1;
+					}
+
+					//scrub the fresh parities, then a flipped word should show as one bad group
+					if( checkVerify( (T**)p, numBuf, nDisk ) ) {
+						errorFlag = 1;
+					}
+
+					//degraded read of a random range, the other bytes and the disks not needed stay as they are
+					if( checkRange( (T**)p, numBuf, nDisk ) ) {
+						errorFlag = 1;
+					}
+
+					//odd pointers and lengths, the parities rebuilt on the aligned buffers after
+					if( checkUnaligned( (T**)p, numBuf, nDisk ) ) {
+						errorFlag = 1;
+					}
+
+					//a random pair through the other kernel family, same layout as the one tested below
+					if( checkFamily( (T**)p, numBuf, nDisk ) ) {
+						errorFlag = 1;
+					}
+
+					//two disks rebuilt into other buffers, the members only read
+					if( checkRecoverTo( (T**)p, numBuf, nDisk ) ) {
+						errorFlag = 1;
+					}
+
+					//the disks pushed through a stream in random pieces, its output as recover() gives
+					if( checkStream( (T**)p, numBuf, nDisk ) ) {
+						errorFlag = 1;
+					}
+
+					//stripes of mixed shapes in one recover_batch() call, as recover() one by one
+					if( checkBatch( nDisk ) ) {
+						errorFlag = 1;
+					}
+
+					//members as segment lists, recovered in place across the segment boundaries
+					if( checkSg( (T**)p, numBuf, nDisk ) ) {
+						errorFlag = 1;
+					}
+
+					//encode, recover and verify jobs through the async engine, its queue depth held
+					if( checkAsync( (T**)p, numBuf, nDisk ) ) {
+						errorFlag = 1;
+					}
+
+					//parities and any two disks rebuilt with the crc32c of every disk in the same pass
+					if( checkCrc( (T**)p, numBuf, nDisk ) ) {
+						errorFlag = 1;
+					}
+
+					//the disks as members of a rotating parity array, encoded and two of them rebuilt
+					if( checkLayout( (T**)p, numBuf, nDisk ) ) {
+						errorFlag = 1;
+					}
+
+					//random writes through a small write-back cache, the parities right after each flush
+					if( checkCache( (T**)p, numBuf, nDisk ) ) {
+						errorFlag = 1;
+					}
+
+					//the array plus an anti-diagonal parity, any three members recovered
+					if( checkStar( (T**)p, numBuf, nDisk ) ) {
+						errorFlag = 1;
+					}
+
+					//the disks copied to buffers on a numa node, a random pair rebuilt by numa pinned workers
+					if( checkNuma( (T**)p, numBuf, nDisk ) ) {
+						errorFlag = 1;
+					}
+				}
+
 				for( int miss1 = nDisk-1; miss1>=0; --miss1) {
 					for( int miss2 = miss1; miss2<nDisk; ++miss2) {
 						//for( int miss2 = miss1; miss2<=miss1; ++miss2) {
-						memcpy(p[eN-2], p[miss1], mBlockSize);	//save original data
-						memcpy(p[eN-1], p[miss2], mBlockSize);	//save original data
+						memcpy(p[numBuf-2], p[miss1], mBlockSize);	//save original data
+						memcpy(p[numBuf-1], p[miss2], mBlockSize);	//save original data
 
 						randBuffer( p[miss1], mBlockSize, 0, eRandOne);
 						randBuffer( p[miss2], mBlockSize, 0, eRandOne);
 
-						if(mCompareMode==-2) { //mix new old engine for test             
-							provider = rand() & 0x01;
-						}
-						//call provider's recover function
-						recover_wrapper( (T**)p, mBlockSize, nDisk, miss1, miss2, provider );
+						//call provider's recover function, every other pair given in reverse
+						int rev = (iter+miss1+miss2) & 1;
+						recover_wrapper( (T**)p, mBlockSize, nDisk, rev? miss2 : miss1, rev? miss1 : miss2, provider );
 
 						printf("(%2d,%2d,%2d)", nDisk, miss1, miss2 );
 
 						//check recover error
-						if ( memcmp(p[eN-2], p[miss1], mBlockSize) 
-							|| memcmp(p[eN-1], p[miss2], mBlockSize) ) {
+						if ( memcmp(p[numBuf-2], p[miss1], mBlockSize) 
+							|| memcmp(p[numBuf-1], p[miss2], mBlockSize) ) {
 								printf("\nrecover error at:size=%dK, NDisk=%d,miss:(%d,%d)\n",
 									mBlockSize/1024, nDisk, miss1, miss2); 
 								randBuffer( p[miss1], mBlockSize, 0, eRandAll);
@@ -376,6 +490,7 @@ public:
 				}//miss disk1
 			}//Ndisk
 		}//iteration            
+		mR6.set_prefetch(prefetch);
 
 		if (errorFlag) {
 			printf("\nHas error!!!!\n");
@@ -390,21 +505,876 @@ public:
 		return 0;
 	}
 
+	//change a data disk, update() parities and check them against recovered ones.
+	//p[numBuf-4] ~ p[numBuf-1] are scratch. return 1 if mismatch.
+	int checkUpdate(T** p, int numBuf, int nDisk, int mode) {
+		int dataIdx = 2 + rand() % (nDisk-2);
+		T* parity[2] = { p[eDiaIdx], p[eRowIdx] };
+		memcpy(p[numBuf-2], p[dataIdx], mBlockSize);	//old data
+		randBuffer( p[dataIdx], mBlockSize, 0, eRandAll);
+		if(eUpdateDiff==mode) {
+			for(int i=mBlockSize/sizeof(T)-1; i>=0; --i) {
+				p[numBuf-2][i] ^= p[dataIdx][i];
+			}
+		}
+		if(eUpdateDiff==mode) 
+			mR6.update( parity, mBlockSize, 0, p[numBuf-2], dataIdx, mode );
+		else
+			mR6.update( parity, mBlockSize, p[numBuf-2], p[dataIdx], dataIdx, mode );
+		memcpy(p[numBuf-4], p[eDiaIdx], mBlockSize);
+		memcpy(p[numBuf-3], p[eRowIdx], mBlockSize);
+
+		mR6.recover( p, mBlockSize, nDisk, eDiaIdx, eRowIdx );
+		if ( memcmp(p[numBuf-4], p[eDiaIdx], mBlockSize) || memcmp(p[numBuf-3], p[eRowIdx], mBlockSize) ) {
+			printf("\nupdate error at:size=%dK, NDisk=%d, data:%d, mode:%d\n",
+				mBlockSize/1024, nDisk, dataIdx, mode); 
+			return 1;
+		}
+		return 0;
+	}
+
+	//verify() clean parities, then flip one data word and find it, then let scrub()
+	//put a corrupted disk right. p[numBuf-1] is scratch. return 1 if wrong.
+	int checkVerify(T** p, int numBuf, int nDisk) {
+		SRaid6Mismatch bad[4];
+		int numBad = -1;
+		if( errOK!=mR6.verify( p, mBlockSize, nDisk, bad, 4, &numBad ) || numBad!=0 ) {
+			printf("\nverify error at:size=%dK, NDisk=%d, clean parity reported bad\n", mBlockSize/1024, nDisk); 
+			return 1;
+		}
+		int diskIdx = 2 + rand() % (nDisk-2);
+		int unit    = rand() % (mBlockSize/sizeof(T));
+		size_t groupBytes = mR6.get_align_bytes();
+		p[diskIdx][unit] ^= 1;
+		int result = mR6.verify( p, mBlockSize, nDisk, bad, 4, &numBad );
+		p[diskIdx][unit] ^= 1;
+		if( errParityMismatch!=result || numBad!=1 || bad[0].offset!=unit*sizeof(T)/groupBytes*groupBytes 
+			|| bad[0].mask!=( (1<<eDiaIdx) | (1<<eRowIdx) ) ) {
+			printf("\nverify error at:size=%dK, NDisk=%d, disk:%d, unit:%d\n", mBlockSize/1024, nDisk, diskIdx, unit); 
+			return 1;
+		}
+
+		//corrupt some words of any one disk, parity disks too
+		diskIdx = rand() % nDisk;
+		memcpy(p[numBuf-1], p[diskIdx], mBlockSize);
+		for(int i=1+rand()%3; i>0; --i) {
+			p[diskIdx][ rand() % (mBlockSize/sizeof(T)) ] ^= (T)rand() + 1;
+		}
+		result = mR6.scrub( p, mBlockSize, nDisk, bad, 4, &numBad );
+		int fixed = numBad>0;
+		for(int i=0; i<numBad && i<4; ++i) {
+			if(bad[i].disk!=diskIdx) fixed = 0;
+		}
+		if( errParityMismatch!=result || !fixed || memcmp(p[numBuf-1], p[diskIdx], mBlockSize) 
+			|| errOK!=mR6.verify( p, mBlockSize, nDisk, 0, 0, 0 ) ) {
+			printf("\nscrub error at:size=%dK, NDisk=%d, disk:%d, result:%d\n", mBlockSize/1024, nDisk, diskIdx, result); 
+			memcpy(p[diskIdx], p[numBuf-1], mBlockSize);
+			return 1;
+		}
+		return 0;
+	}
+
+	static void asyncDone(void* arg, SRaid6Job* job) {
+		*(std::atomic<int>*)arg = job->result==errOK? 1 : 2;
+	}
+
+	struct SResubmit {
+		CRaid6Async*		async;
+		SRaid6Job*			next;				//the job the callback submits
+		std::atomic<int>	result;				//what that submit returned
+		std::atomic<int>	called;				//1 once it has
+	};
+	//submit the next job once the queue is full, at most a few seconds on
+	static void asyncResubmit(void* arg, SRaid6Job* job) {
+		SResubmit* r = (SResubmit*)arg;
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+		while( r->async->get_in_flight()<r->async->get_depth() && std::chrono::steady_clock::now()<end ) {
+			std::this_thread::yield();
+		}
+		r->result = r->async->submit(r->next);
+		r->called = 1;
+	}
+
+	//encode by future, recover a data disk by callback, verify through the completion
+	//queue with more jobs than the depth, callbacks of every worker resubmitting to
+	//the queue they keep full, then a full rejecting engine. p[numBuf-4] ~ p[numBuf-2] 
+	//are scratch. return 1 if wrong.
+	int checkAsync(T** p, int numBuf, int nDisk) {
+		CRaid6Async async(2, 2, eAsyncBlock, mR6.get_prime());
+		async.set_kernel( mR6.get_kernel() );
+		SRaid6Job job;
+		memset( &job, 0, sizeof(job) );
+		job.block    = p;
+		job.numBytes = mBlockSize;
+		job.numDisk  = nDisk;
+
+		memcpy(p[numBuf-4], p[eDiaIdx], mBlockSize);
+		memcpy(p[numBuf-3], p[eRowIdx], mBlockSize);
+		randBuffer( p[eDiaIdx], mBlockSize, 0, eRandOne);
+		randBuffer( p[eRowIdx], mBlockSize, 0, eRandOne);
+		job.op = eAsyncEncode;
+		int wrong = errOK!=async.submit_future(&job).get() 
+			|| memcmp(p[numBuf-4], p[eDiaIdx], mBlockSize) || memcmp(p[numBuf-3], p[eRowIdx], mBlockSize);
+
+		int miss = rand() % nDisk;
+		memcpy(p[numBuf-2], p[miss], mBlockSize);
+		randBuffer( p[miss], mBlockSize, 0, eRandOne);
+		std::atomic<int> done(0);
+		job.op = eAsyncRecover;
+		job.missingDisk1 = job.missingDisk2 = miss;
+		if( errOK!=async.submit(&job, asyncDone, &done) ) wrong = 1;
+		while(!wrong && !done) {
+			std::this_thread::yield();
+		}
+		if( 1!=done || memcmp(p[numBuf-2], p[miss], mBlockSize) ) wrong = 1;
+
+		SRaid6Job verify[3];
+		SRaid6Job* completed[3];
+		int numCompleted = 0;
+		for(int i=0; i<3 && !wrong; ++i) {
+			verify[i] = job;
+			verify[i].op = eAsyncVerify;
+			//the third waits for a slot, it opens once the first two are polled
+			if(2==i) numCompleted += async.wait(completed, 2);
+			if( errOK!=async.submit(&verify[i]) ) wrong = 1;
+		}
+		while(!wrong && numCompleted<3) {
+			int n = async.wait(completed+numCompleted, 3-numCompleted);
+			if(0==n) wrong = 1;
+			numCompleted += n;
+		}
+		for(int i=0; i<numCompleted; ++i) {
+			if( errOK!=completed[i]->result || 0!=completed[i]->numBad ) wrong = 1;
+		}
+
+		//depth as the threads: the callbacks hold every worker while two more jobs fill
+		//the queue, their own submits should be turned down instead of waiting forever
+		if(!wrong) {
+			CRaid6Async busy(2, 2, eAsyncBlock, mR6.get_prime());
+			busy.set_kernel( mR6.get_kernel() );
+			SRaid6Job chain[6];
+			SResubmit resubmit[2];
+			for(int i=0; i<6; ++i) {
+				chain[i] = job;
+				chain[i].op = eAsyncVerify;
+			}
+			for(int i=0; i<2; ++i) {
+				resubmit[i].async  = &busy;
+				resubmit[i].next   = &chain[4+i];
+				resubmit[i].result = errFAIL;
+				resubmit[i].called = 0;
+				if( errOK!=busy.submit(&chain[i], asyncResubmit, &resubmit[i]) ) wrong = 1;
+			}
+			for(int i=2; i<4; ++i) {
+				if( errOK!=busy.submit(&chain[i]) ) wrong = 1;
+			}
+			//the queue mode jobs hold their slots until polled, poll after both callbacks
+			std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+			while( !wrong && !(resubmit[0].called && resubmit[1].called) ) {
+				if( std::chrono::steady_clock::now()>end ) wrong = 1;
+				std::this_thread::yield();
+			}
+			for(numCompleted=0; !wrong && numCompleted<2; ) {
+				int n = busy.wait(completed+numCompleted, 2-numCompleted);
+				if(0==n) wrong = 1;
+				numCompleted += n;
+			}
+			for(int i=0; i<2; ++i) {
+				if( errQueueFull!=resubmit[i].result || errOK!=chain[i].result ) wrong = 1;
+			}
+			for(int i=0; i<numCompleted; ++i) {
+				if( completed[i]!=&chain[2] && completed[i]!=&chain[3] ) wrong = 1;
+			}
+		}
+
+		CRaid6Async reject(1, 1, eAsyncReject, mR6.get_prime());
+		verify[0] = verify[1] = job;
+		verify[0].op = verify[1].op = eAsyncVerify;
+		if( errOK!=reject.submit(&verify[0]) || errQueueFull!=reject.submit(&verify[1]) 
+			|| 1!=reject.wait(completed, 3) || completed[0]!=&verify[0] ) {
+			wrong = 1;
+		}
+
+		if(wrong) {
+			printf("\nasync error at:size=%dK, NDisk=%d, miss:%d\n", mBlockSize/1024, nDisk, miss);
+			memcpy(p[eDiaIdx], p[numBuf-4], mBlockSize);
+			memcpy(p[eRowIdx], p[numBuf-3], mBlockSize);
+			memcpy(p[miss], p[numBuf-2], mBlockSize);
+		}
+		return wrong;
+	}
+
+	//build the parities of buffers at random byte shifts with a random length, then 
+	//recover two random disks of them, through either kernel family. p[numBuf-2], 
+	//p[numBuf-1] are scratch, the parities of p are rebuilt at the end. return 1 if wrong.
+	int checkUnaligned(T** p, int numBuf, int nDisk) {
+		int family = mR6.get_family();
+		mR6.set_family( rand() % eFamilyNum );
+		T* q[eLimitDiskNum+1];
+		for(int i=0; i<nDisk; ++i) {
+			q[i] = (T*)( (char*)p[i] + rand() % 8 );
+		}
+		size_t length = mBlockSize - rand() % mR6.get_align_bytes();
+		if(rand() & 1) length = 1 + rand() % mBlockSize;
+		int miss1 = rand() % nDisk;
+		int miss2 = rand() % nDisk;
+		int result = mR6.recover(q, length, nDisk, eDiaIdx, eRowIdx);
+		memcpy(p[numBuf-2], q[miss1], length);
+		memcpy(p[numBuf-1], q[miss2], length);
+		memset(q[miss1], 0xa5, length);
+		memset(q[miss2], 0xa5, length);
+		if(errOK==result) result = mR6.recover(q, length, nDisk, miss1, miss2);
+		int wrong = errOK!=result || memcmp(p[numBuf-2], q[miss1], length) || memcmp(p[numBuf-1], q[miss2], length);
+		if(wrong) {
+			memcpy(q[miss1], p[numBuf-2], length);
+			memcpy(q[miss2], p[numBuf-1], length);
+			printf("\nunaligned error at:size=%dK, NDisk=%d, miss:(%d,%d), length:%d, family:%d, result:%d\n", 
+				mBlockSize/1024, nDisk, miss1, miss2, (int)length, mR6.get_family(), result);
+		}
+		mR6.set_family(family);
+		mR6.recover(p, mBlockSize, nDisk, eDiaIdx, eRowIdx);
+		return wrong;
+	}
+
+	//recover two random disks with the kernel family not in use, unrolled and 
+	//loop kernels should give the same data. return 1 if wrong.
+	int checkFamily(T** p, int numBuf, int nDisk) {
+		int family = mR6.get_family();
+		int miss1 = rand() % nDisk;
+		int miss2 = miss1 + rand() % (nDisk-miss1);
+		mR6.set_family( eFamilyNum-1-family );
+		memcpy(p[numBuf-2], p[miss1], mBlockSize);
+		memcpy(p[numBuf-1], p[miss2], mBlockSize);
+		randBuffer( p[miss1], mBlockSize, 0, eRandOne);
+		randBuffer( p[miss2], mBlockSize, 0, eRandOne);
+		int result = mR6.recover(p, mBlockSize, nDisk, miss1, miss2);
+		int wrong = errOK!=result || memcmp(p[numBuf-2], p[miss1], mBlockSize) || memcmp(p[numBuf-1], p[miss2], mBlockSize);
+		if(wrong) {
+			memcpy(p[miss1], p[numBuf-2], mBlockSize);
+			memcpy(p[miss2], p[numBuf-1], mBlockSize);
+			printf("\nfamily %d error at:size=%dK, NDisk=%d, miss:(%d,%d), result:%d\n", 
+				eFamilyNum-1-family, mBlockSize/1024, nDisk, miss1, miss2, result);
+		}
+		mR6.set_family(family);
+		return wrong;
+	}
+
+	//recover_sg() two random disks, each member copied into random segments, 4KB 
+	//pages or odd lengths, laid out back to front. return 1 if wrong.
+	int checkSg(T** p, int numBuf, int nDisk) {
+		enum { eMaxSeg = 1024 };
+		size_t group = mR6.get_align_bytes();
+		char* area = (char*)malloc( (size_t)mBlockSize*nDisk );
+		SRaid6Segment* seg = (SRaid6Segment*)malloc( sizeof(SRaid6Segment)*eMaxSeg*nDisk );
+		SRaid6SgList list[eLimitDiskNum+1];
+		int pages = rand() & 1;
+		int miss1 = rand() % nDisk;
+		int miss2 = rand() % nDisk;
+		for(int i=0; i<nDisk; ++i) {
+			char* a = area + (size_t)mBlockSize*i;
+			size_t left = mBlockSize;
+			int n = 0;
+			list[i].seg = seg + eMaxSeg*i;
+			while(left) {
+				size_t len = pages? 4096 : 1 + rand() % (3*group);
+				if(len>left || n==eMaxSeg-1) len = left;
+				left -= len;
+				seg[eMaxSeg*i+n].base = a + left;
+				seg[eMaxSeg*i+n].numBytes = len;
+				if(i==miss1 || i==miss2) memset(a + left, 0xa5, len);
+				else memcpy(a + left, (char*)p[i] + (mBlockSize-left-len), len);
+				++n;
+			}
+			list[i].numSeg = n;
+		}
+		int result = mR6.recover_sg(list, mBlockSize, nDisk, miss1, miss2);
+		int wrong = errOK!=result;
+		for(int m=0; m<2 && !wrong; ++m) {
+			const SRaid6SgList& l = list[ m? miss2 : miss1 ];
+			const char* orig = (const char*)p[ m? miss2 : miss1 ];
+			for(int j=0; j<l.numSeg && !wrong; ++j) {
+				wrong = 0!=memcmp(l.seg[j].base, orig, l.seg[j].numBytes);
+				orig += l.seg[j].numBytes;
+			}
+		}
+		if(wrong) {
+			printf("\nsg error at:size=%dK, NDisk=%d, miss:(%d,%d), pages:%d, result:%d\n", 
+				mBlockSize/1024, nDisk, miss1, miss2, pages, result);
+		}
+		free(seg);
+		free(area);
+		return wrong;
+	}
+
+	//P and Q of the data disks over a random unaligned range, computed byte by byte
+	//here and by CRaid6RS, then two random members of that P+Q stripe recovered. 
+	//the disks are only read. return 1 if wrong.
+	int checkRS(T** p, int numBuf, int nDisk) {
+		if(nDisk>mRS.get_max_disk_num()) return 0;
+		size_t off = rand() % 8;
+		size_t n = 1 + rand() % (mBlockSize-off);
+		unsigned char* area = (unsigned char*)malloc(n*6);
+		unsigned char *refP = area, *refQ = area + n;
+		memset(refP, 0, n*2);
+		for(int d=nDisk-1; d>=2; --d) {	//Q = (..(D[n-1]*g ^ D[n-2])*g ..) ^ D[0]
+			const unsigned char* x = (const unsigned char*)p[d] + off;
+			for(size_t i=0; i<n; ++i) {
+				refQ[i] = (unsigned char)( (refQ[i]<<1) ^ ( (refQ[i] & 0x80)? 0x1d : 0 ) ) ^ x[i];
+				refP[i] ^= x[i];
+			}
+		}
+		T* block[eLimitDiskNum+1];
+		for(int i=2; i<nDisk; ++i) {
+			block[i] = (T*)( (unsigned char*)p[i] + off );
+		}
+		block[eDiaIdx] = (T*)(area + n*2);
+		block[eRowIdx] = (T*)(area + n*3);
+		int result = mRS.recover(block, n, nDisk, eDiaIdx, eRowIdx);
+		int wrong = errOK!=result || memcmp(block[eRowIdx], refP, n) || memcmp(block[eDiaIdx], refQ, n);
+		int miss1 = rand() % nDisk;
+		int miss2 = rand() % nDisk;
+		if(!wrong) {
+			for(int m=0; m<2; ++m) {	//the missing data disks go to the last scratch, never written over
+				int d = m? miss2 : miss1;
+				if(d>=2) block[d] = (T*)(area + n*(4+m));
+				memset(block[d], 0xa5, n);
+			}
+			result = mRS.recover(block, n, nDisk, miss1, miss2);
+			wrong = errOK!=result || memcmp(block[eRowIdx], refP, n) || memcmp(block[eDiaIdx], refQ, n);
+			for(int m=0; m<2; ++m) {
+				int d = m? miss2 : miss1;
+				if(d>=2 && memcmp(block[d], (unsigned char*)p[d] + off, n) ) wrong = 1;
+			}
+		}
+		if(wrong) {
+			printf("\nrs error at:size=%dK, NDisk=%d, offset:%d, length:%d, miss:(%d,%d), result:%d\n", 
+				mBlockSize/1024, nDisk, (int)off, (int)n, miss1, miss2, result);
+		}
+		free(area);
+		return wrong;
+	}
+
+	//nDisk members of a random layout and chunk size, the data from the disks: the 
+	//parity placement of each phase, a random logical range split into chunks, then
+	//each stripe encoded and two random members rebuilt through the layout. 
+	//p[numBuf-2], p[numBuf-1] are scratch. return 1 if wrong.
+	int checkLayout(T** p, int numBuf, int nDisk) {
+		enum { eMaxExt = 64 };
+		CRaid6Layout layout;
+		int kind = rand() % eLayoutNum;
+		size_t chunk = mR6.get_align_bytes()*( 1 + rand() % 4 );
+		if(chunk>(size_t)mBlockSize) chunk = mBlockSize;
+		int numStripe = (int)(mBlockSize/chunk);
+		int wrong = errOK!=layout.set(nDisk, kind, chunk);
+		for(int s=0; s<nDisk && !wrong; ++s) {
+			int left = kind==eLayoutLeftAsymmetric || kind==eLayoutLeftSymmetric;
+			int row = left? nDisk-1-s : s;
+			wrong = layout.get_member(s, eRowIdx)!=row || layout.get_member(s+nDisk, eDiaIdx)!=(row+1)%nDisk;
+			for(int i=0; i<nDisk; ++i) {
+				if( layout.get_block_idx(s, layout.get_member(s, i))!=i ) wrong = 1;
+			}
+		}
+		//a logical range, the pieces should follow on in logical order
+		SRaid6Extent ext[eMaxExt];
+		int numExt = 0;
+		unsigned long long stripeBytes = layout.get_stripe_data_bytes();
+		unsigned long long offset = rand() % (stripeBytes*numStripe);
+		size_t length = 1 + rand() % ( chunk*(eMaxExt-1) );
+		if(!wrong) wrong = errOK!=layout.map(offset, length, ext, eMaxExt, &numExt);
+		for(int i=0; i<numExt && !wrong; ++i) {
+			const SRaid6Extent& e = ext[i];
+			wrong = e.stripe*stripeBytes + (e.blockIdx-2)*chunk + e.offset!=offset || e.member!=layout.get_member(e.stripe, e.blockIdx)
+				|| e.memberOffset!=e.stripe*chunk + e.offset || e.offset+e.numBytes>chunk || (i+1<numExt && e.offset+e.numBytes!=chunk);
+			offset += e.numBytes;
+			length -= e.numBytes;
+		}
+		if(length) wrong = 1;
+
+		char* area = (char*)malloc( (size_t)mBlockSize*nDisk );
+		T* member[eLimitDiskNum+1];
+		int miss1 = rand() % nDisk;
+		int miss2 = rand() % nDisk;
+		for(int i=0; i<nDisk; ++i) {
+			memcpy(area + (size_t)mBlockSize*i, p[i], mBlockSize);
+		}
+		for(int s=0; s<numStripe && !wrong; ++s) {
+			for(int i=0; i<nDisk; ++i) {
+				member[i] = (T*)( area + (size_t)mBlockSize*i + s*chunk );
+			}
+			wrong = errOK!=layout.recover(mR6, s, member, chunk, layout.get_member(s, eDiaIdx), layout.get_member(s, eRowIdx));
+		}
+		memcpy(p[numBuf-2], area + (size_t)mBlockSize*miss1, mBlockSize);
+		memcpy(p[numBuf-1], area + (size_t)mBlockSize*miss2, mBlockSize);
+		memset(area + (size_t)mBlockSize*miss1, 0xa5, mBlockSize);
+		memset(area + (size_t)mBlockSize*miss2, 0xa5, mBlockSize);
+		for(int s=0; s<numStripe && !wrong; ++s) {
+			for(int i=0; i<nDisk; ++i) {
+				member[i] = (T*)( area + (size_t)mBlockSize*i + s*chunk );
+			}
+			wrong = errOK!=layout.recover(mR6, s, member, chunk, miss1, miss2);
+		}
+		wrong = wrong || memcmp(p[numBuf-2], area + (size_t)mBlockSize*miss1, numStripe*chunk) 
+			|| memcmp(p[numBuf-1], area + (size_t)mBlockSize*miss2, numStripe*chunk);
+		if(wrong) {
+			printf("\nlayout error at:size=%dK, NDisk=%d, layout:%d, chunk:%d, miss:(%d,%d)\n", 
+				mBlockSize/1024, nDisk, kind, (int)chunk, miss1, miss2);
+		}
+		free(area);
+		return wrong;
+	}
+
+	//members in memory, one after another
+	struct SMemDisks {
+		char*	area;
+		size_t	memberBytes;
+	};
+	static int memberIo(void* arg, int write, int member, unsigned long long memberOffset, void* buf, size_t numBytes) {
+		SMemDisks* d = (SMemDisks*)arg;
+		char* at = d->area + d->memberBytes*member + memberOffset;
+		if(memberOffset+numBytes>d->memberBytes) return errFAIL;
+		if(write) memcpy(at, buf, numBytes);
+		else memcpy(buf, at, numBytes);
+		return errOK;
+	}
+
+	//a random layout encoded from the disks, then random writes, some following on
+	//and some whole stripes, through a cache of a few stripes against a plain copy
+	//of the logical data. reads in between and after should see the copy, every
+	//stripe should verify after the flush. a whole stripe write should not read.
+	//return 1 if wrong.
+	int checkCache(T** p, int numBuf, int nDisk) {
+		CRaid6Layout layout;
+		size_t chunk = mR6.get_align_bytes()*( 1 + rand() % 4 );
+		if(chunk>(size_t)mBlockSize) chunk = mBlockSize;
+		int numStripe = (int)(mBlockSize/chunk);
+		layout.set(nDisk, rand() % eLayoutNum, chunk);
+		size_t stripeBytes = (size_t)layout.get_stripe_data_bytes();
+		size_t logical = stripeBytes*numStripe;
+		char* area = (char*)malloc( (size_t)mBlockSize*nDisk );
+		char* copy = (char*)malloc(logical);
+		char* buf  = (char*)malloc(logical);
+		SMemDisks disks = { area, (size_t)mBlockSize };
+		T* member[eLimitDiskNum+1];
+		for(int i=0; i<nDisk; ++i) {
+			memcpy(area + (size_t)mBlockSize*i, p[i], mBlockSize);
+		}
+		for(int s=0; s<numStripe; ++s) {
+			for(int i=0; i<nDisk; ++i) {
+				member[i] = (T*)( area + (size_t)mBlockSize*i + s*chunk );
+			}
+			layout.recover(mR6, s, member, chunk, layout.get_member(s, eDiaIdx), layout.get_member(s, eRowIdx));
+		}
+
+		CRaid6Cache cache(mR6, 1 + rand() % 4);
+		int wrong = errOK!=cache.begin(layout, memberIo, &disks) || errOK!=cache.read(0, copy, logical);
+		size_t next = 0;
+		for(int w=0; w<32 && !wrong; ++w) {
+			size_t off = (rand() & 1)? next : rand() % logical;
+			size_t len = 1 + rand() % ( (rand() & 1)? 64 : chunk*2 );
+			if(off+len>logical) len = logical-off;
+			randBuffer( (T*)buf, (int)( (len+sizeof(T)-1)/sizeof(T)*sizeof(T) ), 0, eRandAll);
+			memcpy(copy + off, buf, len);
+			wrong = errOK!=cache.write(off, buf, len);
+			next = off+len<logical? off+len : 0;
+			if(rand() & 1) {
+				off = rand() % logical;
+				len = 1 + rand() % (logical-off);
+				wrong = wrong || errOK!=cache.read(off, buf, len) || memcmp(buf, copy + off, len);
+			}
+		}
+		wrong = wrong || errOK!=cache.flush() || cache.get_cached_num()!=0;
+
+		//a whole stripe, encoded without reading
+		SRaid6CacheStats before, after;
+		size_t s0 = (size_t)( rand() % numStripe )*stripeBytes;
+		cache.get_stats(&before);
+		randBuffer( (T*)buf, (int)stripeBytes, 0, eRandAll);
+		memcpy(copy + s0, buf, stripeBytes);
+		wrong = wrong || errOK!=cache.write(s0, buf, stripeBytes) || errOK!=cache.flush();
+		cache.get_stats(&after);
+		wrong = wrong || after.memberReads!=before.memberReads || after.flush[eFlushFull]!=before.flush[eFlushFull]+1;
+
+		for(int s=0; s<numStripe && !wrong; ++s) {
+			for(int i=0; i<nDisk; ++i) {
+				member[i] = (T*)( area + (size_t)mBlockSize*i + s*chunk );
+			}
+			T* block[eLimitDiskNum+1];
+			layout.build_block(s, member, block);
+			wrong = errOK!=mR6.verify(block, chunk, nDisk, 0, 0, 0);
+		}
+		wrong = wrong || errOK!=cache.read(0, buf, logical) || memcmp(buf, copy, logical);
+		if(wrong) {
+			printf("\ncache error at:size=%dK, NDisk=%d, layout:%d, chunk:%d\n", 
+				mBlockSize/1024, nDisk, layout.get_layout(), (int)chunk);
+		}
+		free(buf);
+		free(copy);
+		free(area);
+		return wrong;
+	}
+
+	//the disks as a STAR array with the anti-diagonal parity in p[numBuf-4], its 
+	//row and diagonal parities should be the ones there. then three random members
+	//recovered, p[numBuf-3] ~ p[numBuf-1] keep them. return 1 if wrong.
+	int checkStar(T** p, int numBuf, int nDisk) {
+		T* block[eLimitDiskNum+1];
+		int nd = nDisk+1;
+		for(int i=0; i<nDisk; ++i) {
+			block[i] = p[i];
+		}
+		block[nDisk] = p[numBuf-4];
+		memcpy(p[numBuf-3], p[eDiaIdx], mBlockSize);
+		memcpy(p[numBuf-2], p[eRowIdx], mBlockSize);
+		int result = mR6.recover_star(block, mBlockSize, nd, eDiaIdx, eRowIdx, nDisk);
+		int wrong = errOK!=result || memcmp(p[numBuf-3], p[eDiaIdx], mBlockSize) || memcmp(p[numBuf-2], p[eRowIdx], mBlockSize);
+		int miss[3] = { rand() % nd, rand() % nd, rand() % nd };
+		if(!wrong) {
+			for(int m=0; m<3; ++m) {
+				memcpy(p[numBuf-3+m], block[ miss[m] ], mBlockSize);
+			}
+			for(int m=0; m<3; ++m) {
+				randBuffer( block[ miss[m] ], mBlockSize, 0, eRandOne);
+			}
+			result = mR6.recover_star(block, mBlockSize, nd, miss[0], miss[1], miss[2]);
+			for(int m=0; m<3; ++m) {
+				if( memcmp(p[numBuf-3+m], block[ miss[m] ], mBlockSize) ) wrong = 1;
+			}
+			wrong |= errOK!=result;
+			if(wrong) {
+				for(int m=2; m>=0; --m) {
+					memcpy(block[ miss[m] ], p[numBuf-3+m], mBlockSize);
+				}
+			}
+		}
+		if(wrong) {
+			printf("\nstar error at:size=%dK, NDisk=%d, miss:(%d,%d,%d), result:%d\n", 
+				mBlockSize/1024, nd, miss[0], miss[1], miss[2], result);
+		}
+		return wrong;
+	}
+
+	//the disks copied into buffers placed on a random numa node, which should be
+	//where their pages are if the os tells. then two random disks recovered there 
+	//by an engine with numa workers. return 1 if wrong.
+	int checkNuma(T** p, int numBuf, int nDisk) {
+		T* block[eLimitDiskNum+1];
+		int node[eLimitDiskNum+1];
+		int want = rand() % CRaid6Numa::get_node_num();
+		int miss1 = rand() % nDisk;
+		int miss2 = rand() % nDisk;
+		int wrong = 0;
+		for(int i=0; i<nDisk; ++i) {
+			block[i] = (T*)CRaid6Numa::alloc(mBlockSize, want);
+			if(block[i]) memcpy(block[i], p[i], mBlockSize);
+			else wrong = 1;
+		}
+		if(!wrong) {
+			CRaid6Numa::get_mem_node( (const void* const*)block, nDisk, node );
+			for(int i=0; i<nDisk; ++i) {
+				if(node[i]>=0 && node[i]!=want) wrong = 1;
+			}
+			CRaid6 r6;
+			r6.set_prime( mR6.get_prime() );
+			r6.set_kernel( mR6.get_kernel() );
+			r6.set_family( mR6.get_family() );
+			r6.set_numa(1);
+			r6.set_thread_num(2);
+			randBuffer( block[miss1], mBlockSize, 0, eRandOne);
+			randBuffer( block[miss2], mBlockSize, 0, eRandOne);
+			int result = r6.recover(block, mBlockSize, nDisk, miss1, miss2);
+			wrong = wrong || errOK!=result || !r6.get_numa() || memcmp(block[miss1], p[miss1], mBlockSize) 
+				|| memcmp(block[miss2], p[miss2], mBlockSize);
+		}
+		if(wrong) {
+			printf("\nnuma error at:size=%dK, NDisk=%d, node:%d, miss:(%d,%d)\n", 
+				mBlockSize/1024, nDisk, want, miss1, miss2);
+		}
+		for(int i=0; i<nDisk; ++i) {
+			CRaid6Numa::release(block[i], mBlockSize);
+		}
+		return wrong;
+	}
+
+	//the data a stream hands out of each missing disk, appended
+	struct SStreamOut {
+		char*	out[eLimitDiskNum+1];
+		size_t	done[eLimitDiskNum+1];
+		size_t	cap;
+	};
+	static int streamOut(void* arg, int diskIdx, const void* data, size_t numBytes) {
+		SStreamOut* o = (SStreamOut*)arg;
+		if(!o->out[diskIdx] || o->done[diskIdx]+numBytes>o->cap) return errFAIL;
+		memcpy(o->out[diskIdx] + o->done[diskIdx], data, numBytes);
+		o->done[diskIdx] += numBytes;
+		return errOK;
+	}
+
+	//the surviving disks pushed through a stream with a window smaller than the
+	//buffers, in pieces of random sizes, whole groups or not, some from odd
+	//addresses, the total a partial last group half the time. three odd sized
+	//pieces go first, then a large one runs on from an odd offset. the missing disks
+	//handed out should be what recover() gives on the whole buffers, the disks 
+	//cut at the total. p[numBuf-2], p[numBuf-1] are scratch. return 1 if wrong.
+	int checkStream(T** p, int numBuf, int nDisk) {
+		size_t group = mR6.get_align_bytes();
+		size_t window = group*( 1 + rand() % 4 );
+		int miss1 = rand() % nDisk;
+		int miss2 = rand() % nDisk;
+		if( 0==(rand() & 3) ) {		//the encoder
+			miss1 = eDiaIdx;
+			miss2 = eRowIdx;
+		}
+		SStreamOut o;
+		memset(&o, 0, sizeof(o));
+		o.out[miss2] = (char*)p[numBuf-1];
+		o.out[miss1] = (char*)p[numBuf-2];
+		o.cap = mBlockSize;
+		std::vector<char> bounce( (size_t)(mBlockSize+8)*nDisk );
+
+		//the disks zero after the total, their parities rebuilt over the last group padded so
+		size_t total = mBlockSize - ( (rand() & 1)? rand() % group : 0 );
+		std::vector<T> area( mBlockSize/sizeof(T)*nDisk );
+		T* d[eLimitDiskNum+1];
+		for(int i=0; i<nDisk; ++i) {
+			d[i] = &area[ mBlockSize/sizeof(T)*i ];
+			memcpy(d[i], p[i], total);
+		}
+		mR6.recover(d, mBlockSize, nDisk, eDiaIdx, eRowIdx);
+
+		CRaid6Stream stream(mR6, window);
+		int result = stream.begin(nDisk, miss1, miss2, streamOut, &o);
+		const void* piece[eLimitDiskNum+1];
+		for(size_t off=0, step=0; off<total && errOK==result; ++step) {
+			size_t n;
+			switch(step<3? 3 : step==3? 4 : rand() % 3) {
+			case 0:  n = group*( 1 + rand() % 8 ); break;		//whole groups, straight if nothing staged
+			case 1:  n = 1 + rand() % 64; break;				//a partial group carried on
+			case 3:  n = 1 + 2*( rand() % 4 ); break;			//odd, the offset after them too
+			case 4:  n = window*3 + group; break;				//past the window staged, whole groups at an odd offset
+			default: n = 1 + rand() % (window*3); break;
+			}
+			if(n>total-off) n = total-off;
+			int odd = 0==(rand() & 3)? 1 + rand() % 7 : 0;
+			for(int i=0; i<nDisk; ++i) {
+				piece[i] = (char*)d[i] + off;
+				if(odd) {
+					char* at = &bounce[ (size_t)(mBlockSize+8)*i + odd ];
+					memcpy(at, piece[i], n);
+					piece[i] = at;
+				}
+				if(i==miss1 || i==miss2) piece[i] = 0;
+			}
+			result = stream.push(piece, n);
+			off += n;
+		}
+		if(errOK==result) result = stream.finish( (char*)d[eDiaIdx] + total );
+		size_t len1 = eDiaIdx==miss1? mR6.get_dia_bytes(total) : total;
+		size_t len2 = eDiaIdx==miss2? mR6.get_dia_bytes(total) : total;
+		int wrong = errOK!=result || stream.get_total_bytes()!=total || o.done[miss1]!=len1 || o.done[miss2]!=len2
+			|| memcmp(p[numBuf-2], d[miss1], len1) || ( miss2!=miss1 && memcmp(p[numBuf-1], d[miss2], len2) );
+		if(wrong) {
+			printf("\nstream error at:size=%dK, total=%d, NDisk=%d, window=%d, miss:(%d,%d), result:%d\n", 
+				mBlockSize/1024, (int)total, nDisk, (int)window, miss1, miss2, result);
+		}
+		return wrong;
+	}
+
+	//recover_batch() of stripes with random disk numbers, lengths and missing
+	//pairs in either order, plus one with a bad disk number. each stripe's result
+	//and data should be what its own recover() call gives. return 1 if wrong.
+	int checkBatch(int nDisk) {
+		enum { eStripes = 6 };
+		SRaid6Stripe stripe[eStripes+1];
+		std::vector<T> area[eStripes], save[eStripes];
+		std::vector<T*> block[eStripes];
+		size_t align = mR6.get_align_bytes();
+		for(int i=0; i<eStripes; ++i) {
+			int n = 3 + rand() % (nDisk-2);
+			size_t numBytes = align*( 1 + rand() % 4 ) - ( (rand() & 1)? rand() % align : 0 );
+			size_t units = ( mR6.get_dia_bytes(numBytes) + sizeof(T)-1 )/sizeof(T);
+			area[i].resize(units*n);
+			block[i].resize(n);
+			for(int d=0; d<n; ++d) {
+				block[i][d] = &area[i][units*d];
+				randBuffer( block[i][d], (int)(units*sizeof(T)), 0, eRandAll);
+			}
+			mR6.recover(&block[i][0], numBytes, n, eDiaIdx, eRowIdx);
+			save[i] = area[i];
+			SRaid6Stripe& s = stripe[i];
+			s.block = &block[i][0];
+			s.numBytes = numBytes;
+			s.numDisk = n;
+			s.missingDisk1 = rand() % n;
+			s.missingDisk2 = rand() % n;
+			if(0==i) {		//one pair surely reversed
+				s.missingDisk1 = n-1;
+				s.missingDisk2 = rand() % (n-1);
+			}
+			s.result = errFAIL;
+		}
+		stripe[eStripes] = stripe[0];
+		stripe[eStripes].numDisk = 2;
+
+		//the missing disks spoiled, as far as recover() writes them
+		for(int i=0; i<eStripes; ++i) {
+			SRaid6Stripe& s = stripe[i];
+			memset( s.block[s.missingDisk1], 0x5a, s.missingDisk1==eDiaIdx? mR6.get_dia_bytes(s.numBytes) : s.numBytes );
+			memset( s.block[s.missingDisk2], 0x5a, s.missingDisk2==eDiaIdx? mR6.get_dia_bytes(s.numBytes) : s.numBytes );
+		}
+		int result = mR6.recover_batch(stripe, eStripes+1);
+		int wrong = result!=stripe[eStripes].result || errOK==result;
+		for(int i=0; i<eStripes+1; ++i) {
+			SRaid6Stripe& s = stripe[i];
+			int own = mR6.recover(s.block, s.numBytes, s.numDisk, s.missingDisk1, s.missingDisk2);
+			if( own!=s.result || (i<eStripes && area[i]!=save[i]) ) {
+				wrong = 1;
+				printf("\nbatch error at:stripe %d, bytes=%d, NDisk=%d, miss:(%d,%d), result:%d, own:%d\n", 
+					i, (int)s.numBytes, s.numDisk, s.missingDisk1, s.missingDisk2, s.result, own);
+			}
+		}
+		return wrong;
+	}
+
+	//recover_to() two random disks into the scratch buffers, the members stay as
+	//they are, the missing ones' entries 0. p[numBuf-2], p[numBuf-1] are scratch. 
+	//return 1 if wrong.
+	int checkRecoverTo(T** p, int numBuf, int nDisk) {
+		const T* in[eLimitDiskNum+1];
+		unsigned crc[eLimitDiskNum+1];
+		int miss1 = rand() % nDisk;
+		int miss2 = rand() % nDisk;
+		for(int i=0; i<nDisk; ++i) {
+			in[i] = p[i];
+			crc[i] = CRaid6::crc32c(0, p[i], mBlockSize);
+		}
+		in[miss1] = in[miss2] = 0;
+		memset(p[numBuf-2], 0xa5, mBlockSize);
+		memset(p[numBuf-1], 0xa5, mBlockSize);
+		int result = mR6.recover_to(in, mBlockSize, nDisk, miss1, miss2, p[numBuf-2], p[numBuf-1]);
+		int wrong = errOK!=result || memcmp(p[numBuf-2], p[miss1], mBlockSize) 
+			|| ( miss2!=miss1 && memcmp(p[numBuf-1], p[miss2], mBlockSize) );
+		for(int i=0; i<nDisk; ++i) {
+			if( crc[i]!=CRaid6::crc32c(0, p[i], mBlockSize) ) wrong = 1;
+		}
+		if(wrong) {
+			printf("\nrecover_to error at:size=%dK, NDisk=%d, miss:(%d,%d), result:%d\n", 
+				mBlockSize/1024, nDisk, miss1, miss2, result);
+		}
+		return wrong;
+	}
+
+	//recover_range() a random byte range of two random disks, with the disks
+	//get_range() does not need and the bytes out of range of the missing disks 
+	//overwritten. p[numBuf-4] ~ p[numBuf-1] are scratch. return 1 if wrong.
+	int checkRange(T** p, int numBuf, int nDisk) {
+		int miss1 = rand() % nDisk;
+		int miss2 = rand() % nDisk;
+		size_t offset = rand() % mBlockSize;
+		size_t length = 1 + rand() % (mBlockSize-offset);
+		if(rand() & 1) length = 1 + rand() % 4096;
+		if(length>mBlockSize-offset) length = mBlockSize-offset;
+		SRaid6Range range;
+		unsigned char need[eLimitDiskNum+1];
+		int result = mR6.get_range(nDisk, miss1, miss2, offset, length, &range, need);
+		if( errOK!=result || range.offset>offset || range.offset+range.numBytes<offset+length 
+			|| range.offset+range.numBytes>(size_t)mBlockSize || range.numBytes%mR6.get_align_bytes() ) {
+			printf("\nrange error at:size=%dK, NDisk=%d, offset:%d, length:%d\n", mBlockSize/1024, nDisk, (int)offset, (int)length);
+			return 1;
+		}
+		//parities not needed get garbage, restored after
+		memcpy(p[numBuf-4], p[eDiaIdx], mBlockSize);
+		memcpy(p[numBuf-3], p[eRowIdx], mBlockSize);
+		memcpy(p[numBuf-2], p[miss1], mBlockSize);
+		memcpy(p[numBuf-1], p[miss2], mBlockSize);
+		for(int i=eDiaIdx; i<=eRowIdx; ++i) {
+			if(!need[i] && i!=miss1 && i!=miss2) randBuffer( p[i], mBlockSize, 0, eRandAll);
+		}
+		memset(p[miss1], 0xa5, mBlockSize);
+		memset(p[miss2], 0xa5, mBlockSize);
+		result = mR6.recover_range(p, mBlockSize, nDisk, miss1, miss2, offset, length);
+		int wrong = errOK!=result;
+		for(int m=0; m<2; ++m) {
+			const unsigned char* got  = (const unsigned char*)p[ m? miss2 : miss1 ];
+			const unsigned char* orig = (const unsigned char*)p[ numBuf-2+m ];
+			for(size_t i=0; i<(size_t)mBlockSize; ++i) {
+				int inRange = i>=range.offset && i<range.offset+range.numBytes;
+				if( inRange? got[i]!=orig[i] : got[i]!=0xa5 ) {
+					wrong = 1;
+					break;
+				}
+			}
+		}
+		memcpy(p[miss1], p[numBuf-2], mBlockSize);
+		memcpy(p[miss2], p[numBuf-1], mBlockSize);
+		memcpy(p[eDiaIdx], p[numBuf-4], mBlockSize);
+		memcpy(p[eRowIdx], p[numBuf-3], mBlockSize);
+		if(wrong) {
+			printf("\nrange error at:size=%dK, NDisk=%d, miss:(%d,%d), offset:%d, length:%d, result:%d\n", 
+				mBlockSize/1024, nDisk, miss1, miss2, (int)offset, (int)length, result);
+			return 1;
+		}
+		return 0;
+	}
+
+	//recover_crc() parities then two random disks, each disk's crc should match 
+	//crc32c() of the buffer. p[numBuf-4] ~ p[numBuf-1] are scratch. return 1 if wrong.
+	int checkCrc(T** p, int numBuf, int nDisk) {
+		unsigned crc[eLimitDiskNum+1], crc2[eLimitDiskNum+1];
+		if( 0xE3069283u!=CRaid6::crc32c(0, "123456789", 9) ) {
+			printf("\ncrc32c error, check value %08x\n", CRaid6::crc32c(0, "123456789", 9) ); 
+			return 1;
+		}
+		memcpy(p[numBuf-4], p[eDiaIdx], mBlockSize);
+		memcpy(p[numBuf-3], p[eRowIdx], mBlockSize);
+		memset( (void*)crc, 0, sizeof(crc) );
+		int result = mR6.recover_crc( p, mBlockSize, nDisk, eDiaIdx, eRowIdx, crc );
+		int wrong = errOK!=result || memcmp(p[numBuf-4], p[eDiaIdx], mBlockSize) || memcmp(p[numBuf-3], p[eRowIdx], mBlockSize);
+		for(int i=0; i<nDisk; ++i) {
+			if( crc[i]!=CRaid6::crc32c(0, p[i], mBlockSize) ) wrong = 1;
+		}
+		if(wrong) {
+			printf("\ncrc error at:size=%dK, NDisk=%d, parities, result:%d\n", mBlockSize/1024, nDisk, result); 
+			return 1;
+		}
+
+		int miss1 = rand() % nDisk;
+		int miss2 = rand() % nDisk;
+		memcpy(p[numBuf-2], p[miss1], mBlockSize);
+		memcpy(p[numBuf-1], p[miss2], mBlockSize);
+		randBuffer( p[miss1], mBlockSize, 0, eRandOne);
+		randBuffer( p[miss2], mBlockSize, 0, eRandOne);
+		memset( (void*)crc2, 0, sizeof(crc2) );
+		result = mR6.recover_crc( p, mBlockSize, nDisk, miss1, miss2, crc2 );
+		wrong = errOK!=result || memcmp(p[numBuf-2], p[miss1], mBlockSize) || memcmp(p[numBuf-1], p[miss2], mBlockSize);
+		for(int i=0; i<nDisk; ++i) {
+			if( crc2[i]!=crc[i] ) wrong = 1;
+		}
+		if(wrong) {
+			printf("\ncrc error at:size=%dK, NDisk=%d, miss:(%d,%d), result:%d\n", mBlockSize/1024, nDisk, miss1, miss2, result); 
+			memcpy(p[miss1], p[numBuf-2], mBlockSize);
+			memcpy(p[miss2], p[numBuf-1], mBlockSize);
+			return 1;
+		}
+		return 0;
+	}
+
 	int recover_wrapper(T** block, int numBytes, int numDisk, int miss1, int miss2, int provider){        
 		int categray=0;	//which type of recover
-		if(miss1==miss2) {
-			if (0==miss1)           
+		int lo = miss1<miss2? miss1 : miss2;
+		int hi = miss1<miss2? miss2 : miss1;
+		if(lo==hi) {
+			if (0==lo)           
 				categray = 0;
-			else if (1==miss1)      
+			else if (1==lo)      
 				categray = 1;
 			else                    
 				categray = 2; 
-		}else if(0==miss1) {
-			if(1==miss2)            
+		}else if(0==lo) {
+			if(1==hi)            
 				categray = 3;
 			else                    
 				categray = 4;
-		}else if(1==miss1){         
+		}else if(1==lo){         
 			categray = 5;
 		}   
 		else { 
@@ -416,7 +1386,7 @@ public:
 		timer[provider].start();
 		if(provider==eUseEx) {
 			//call other raid6 provider's recover function here
-
+			mRS.recover( block, numBytes, numDisk, miss1, miss2 );
 		}else{
 			mR6.recover( block, numBytes, numDisk, miss1, miss2 );
 		}        
@@ -438,7 +1408,7 @@ public:
 			printf("%14s", "   MY:    US: |" );
 		}
 
-		for(nd=3; nd<=eImpDiskNum; ++nd) {            
+		for(nd=3; nd<=mNumDisk; ++nd) {            
 			printf("\ndisk:%3d |", nd);
 			for(cat=0; cat<=6; ++cat){
 				printf("%6.3f,%6.3f |", mTime[0][nd][cat]/mCount[0][nd][cat], mTime[1][nd][cat]/mCount[1][nd][cat] );
@@ -472,6 +1442,10 @@ void printHelp() {
 		"\ni<number>(iteration times)"
 		"\nn<number>(max disk number)"
 		"\ns<number>(block size in KB)"
+		"\nk<number>(kernel variant, 0:scalar 1:sse2 2:avx2 3:avx512)"
+		"\nf<number>(kernel family, 0:unrolled 1:loop)"
+		"\nt<number>(worker threads of recover)"
+		"\np<number>(prime, 5 17 or 257. max disk number up to prime+2)"
 		"\nd(dump current raid6 setting)"
 		"\nh(help)\n"
 		);
@@ -488,6 +1462,10 @@ int main(int argc, char* argv[])
 	int mode    = CRaid6_Test::eUseMy;
 	int ndisk   = raid6::eImpDiskNum;
 	int size    = 512*1024;
+	int kernel  = 0;
+	int family  = 0;
+	int threads = 1;
+	int prime   = raid6::P;
 	aTest.initParam(size, iter, ndisk, -1, -1, mode);
 
 	int c = 0;
@@ -526,6 +1504,34 @@ int main(int argc, char* argv[])
 			printf("compare two implementations...and the testing order is fully mixed.\n");
 			mode=CRaid6_Test::eCompareMixedBoth;
 			break;
+		case 'k':
+			kernel = getValue();
+			if( errOK==aTest.setKernel(kernel) ) 
+				printf("kernel variant:%d\n", kernel);
+			else
+				printf("kernel variant %d not supported\n", kernel);
+			break;
+		case 'f':
+			family = getValue();
+			if( errOK==aTest.setFamily(family) ) 
+				printf("kernel family:%d\n", family);
+			else
+				printf("invalid kernel family %d\n", family);
+			break;
+		case 't':
+			threads = getValue();
+			if( errOK==aTest.setThreadNum(threads) ) 
+				printf("worker threads:%d\n", threads);
+			else
+				printf("invalid worker threads %d\n", threads);
+			break;
+		case 'p':
+			prime = getValue();
+			if( errOK==aTest.setPrime(prime) ) 
+				printf("prime:%d\n", prime);
+			else
+				printf("prime %d not supported\n", prime);
+			break;
 		case 'd':
 			aTest.dump();
 			break;